@@ -0,0 +1,1017 @@
+/*
+  ==============================================================================
+
+    Benchmark.cpp
+    Created: 16 Oct 2026 3:02:26pm
+    Author:  Morris Sound
+
+  ==============================================================================
+*/
+
+#include "Benchmark.h"
+#include "../VoxProcessor/Source/PluginEditor.h"
+
+//==============================================================================
+/*
+ Counts the allocations made while processBlock() runs.
+ Only the thread that turned counting on is counted, so the message thread and JUCE's timer thread don't show up.
+ */
+namespace
+{
+    thread_local bool countAllocationsOnThisThread = false;
+    std::atomic<juce::int64> numAllocations { 0 };
+
+    struct ScopedAllocationCounter
+    {
+        ScopedAllocationCounter() : startCount(numAllocations.load()) { countAllocationsOnThisThread = true; }
+        ~ScopedAllocationCounter() { countAllocationsOnThisThread = false; }
+        juce::int64 getCount() const { return numAllocations.load() - startCount; }
+
+        juce::int64 startCount;
+    };
+}
+
+void* operator new (std::size_t size)
+{
+    if( countAllocationsOnThisThread )
+        numAllocations.fetch_add(1, std::memory_order_relaxed);
+
+    if( auto* ptr = std::malloc(size == 0 ? 1 : size) )
+        return ptr;
+
+    throw std::bad_alloc();
+}
+
+void* operator new[] (std::size_t size)                 { return operator new (size); }
+void operator delete (void* ptr) noexcept               { std::free(ptr); }
+void operator delete[] (void* ptr) noexcept             { std::free(ptr); }
+void operator delete (void* ptr, std::size_t) noexcept  { std::free(ptr); }
+void operator delete[] (void* ptr, std::size_t) noexcept{ std::free(ptr); }
+
+//==============================================================================
+static juce::String getOptionName(Benchmark::DSP_Option option)
+{
+    switch (option)
+    {
+        case Benchmark::DSP_Option::Phase:          return "phaser";
+        case Benchmark::DSP_Option::Chorus:         return "chorus";
+        case Benchmark::DSP_Option::OverDrive:      return "overdrive";
+        case Benchmark::DSP_Option::LadderFilter:   return "ladderFilter";
+        case Benchmark::DSP_Option::GeneralFilter:  return "generalFilter";
+        case Benchmark::DSP_Option::END_OF_LIST:    break;
+    }
+    return "none";
+}
+
+static juce::String getStageName(VoxProcessorAudioProcessor::ProfiledStage stage)
+{
+    using Stage = VoxProcessorAudioProcessor::ProfiledStage;
+    switch (stage)
+    {
+        case Stage::Phaser:         return "phaser";
+        case Stage::Chorus:         return "chorus";
+        case Stage::OverDrive:      return "overdrive";
+        case Stage::LadderFilter:   return "ladderFilter";
+        case Stage::GeneralFilter:  return "generalFilter";
+        case Stage::InputGain:      return "inputGain";
+        case Stage::OutputGain:     return "outputGain";
+        case Stage::Metering:       return "rmsMetering";
+        case Stage::AnalyzerFifo:   return "analyzerFifoPush";
+        case Stage::Control:        return "control";
+        case Stage::END_OF_LIST:    break;
+    }
+    return "unknown";
+}
+
+/*
+ ns/sample plus the tail of the per block distribution, in ns per block.
+ */
+static juce::var summarise(std::vector<double>& blockNs, double numSamples)
+{
+    auto* obj = new juce::DynamicObject();
+    if( blockNs.empty() )
+        return obj;
+
+    auto total = std::accumulate(blockNs.begin(), blockNs.end(), 0.0);
+    std::sort(blockNs.begin(), blockNs.end());
+
+    auto percentile = [&blockNs](double p)
+    {
+        auto index = static_cast<size_t>(p * static_cast<double>(blockNs.size() - 1) + 0.5);
+        return blockNs[juce::jmin(index, blockNs.size() - 1)];
+    };
+
+    obj->setProperty("nsPerSample", total / numSamples);
+    obj->setProperty("p50", percentile(0.5));
+    obj->setProperty("p90", percentile(0.9));
+    obj->setProperty("p99", percentile(0.99));
+    obj->setProperty("p999", percentile(0.999));
+    obj->setProperty("max", blockNs.back());
+    return obj;
+}
+
+//==============================================================================
+Benchmark::Benchmark(Settings s) : settings(std::move(s))
+{
+}
+
+Benchmark::DSP_Order Benchmark::getDefaultOrder()
+{
+    DSP_Order order;
+    for( size_t i = 0; i < order.size(); ++i )
+        order[i] = static_cast<DSP_Option>(i);
+    return order;
+}
+
+int Benchmark::run()
+{
+    std::vector<Config> configs;
+    const auto defaultOrder = getDefaultOrder();
+
+    for( auto sampleRate : settings.sampleRates )
+    {
+        for( auto blockSize : settings.blockSizes )
+        {
+            Config c;
+            c.scenario = "blockSizeSampleRate";
+            c.sampleRate = sampleRate;
+            c.blockSize = blockSize;
+            c.order = defaultOrder;
+            c.seconds = settings.secondsPerRun;
+            configs.push_back(c);
+        }
+    }
+
+    auto addOrderAndBypassRuns = [&](const juce::String& scenario, bool everyOrder, bool everyBypass)
+    {
+        auto order = defaultOrder;
+        do
+        {
+            for( int mask = 0; mask < (everyBypass ? (1 << numOptions) : 1); ++mask )
+            {
+                Config c;
+                c.scenario = scenario;
+                c.order = order;
+                c.seconds = settings.secondsPerRun;
+                for( size_t i = 0; i < numOptions; ++i )
+                    c.bypassed[i] = (mask & (1 << i)) != 0;
+                configs.push_back(c);
+            }
+        }
+        while( everyOrder && std::next_permutation(order.begin(), order.end()) );
+    };
+
+    if( settings.exhaustive )
+    {
+        addOrderAndBypassRuns("orderAndBypass", true, true);
+    }
+    else
+    {
+        if( settings.allOrders )
+            addOrderAndBypassRuns("order", true, false);
+        if( settings.allBypassStates )
+            addOrderAndBypassRuns("bypass", false, true);
+    }
+
+    //no automation at all, with the control rate stages updated every control block against once per block
+    //as soon as the smoothers have arrived.
+    for( auto blockSize : settings.blockSizes )
+    {
+        for( auto adaptive : { false, true } )
+        {
+            Config c;
+            c.scenario = "staticSettings";
+            c.blockSize = blockSize;
+            c.order = defaultOrder;
+            c.adaptiveControlRate = adaptive;
+            c.seconds = settings.secondsPerRun;
+            configs.push_back(c);
+        }
+    }
+    
+    //every bus layout we ship on, from mono vocals to immersive beds. A run fails if the layout is refused
+    //or the output isn't finite.
+    for( const auto& layout : { juce::AudioChannelSet::mono(),
+                                juce::AudioChannelSet::stereo(),
+                                juce::AudioChannelSet::createLCR(),
+                                juce::AudioChannelSet::create5point1(),
+                                juce::AudioChannelSet::create7point1point4() } )
+    {
+        Config c;
+        c.scenario = "layout";
+        c.order = defaultOrder;
+        c.layout = layout;
+        c.seconds = settings.secondsPerRun;
+        configs.push_back(c);
+    }
+
+    //every oversampling mode on the overdrive and ladder filter, then once more with both of them bypassed:
+    //a bypassed stage must only cost its compensation delay.
+    for( int m = 0; m < static_cast<int>(OversamplingMode::END_OF_LIST); ++m )
+    {
+        for( auto bypassNonlinearStages : { false, true } )
+        {
+            Config c;
+            c.scenario = "oversampling";
+            c.order = defaultOrder;
+            c.oversampling = static_cast<OversamplingMode>(m);
+            c.bypassed[static_cast<size_t>(DSP_Option::OverDrive)] = bypassNonlinearStages;
+            c.bypassed[static_cast<size_t>(DSP_Option::LadderFilter)] = bypassNonlinearStages;
+            c.seconds = settings.secondsPerRun;
+            configs.push_back(c);
+        }
+    }
+
+    //a track that stops: the tails ring out, then the stages should go to sleep and cost next to nothing.
+    //once with every stage oversampled, so the sleep has to wait for the oversampling filters too.
+    for( auto oversampling : { OversamplingMode::Off, OversamplingMode::FIR4x } )
+    {
+        Config c;
+        c.scenario = "silence";
+        c.order = defaultOrder;
+        c.oversampling = oversampling;
+        c.silentInput = true;
+        c.seconds = settings.secondsPerRun;
+        configs.push_back(c);
+    }
+
+    //10 seconds of general filter and ladder cutoff automation. Any allocation here is an xrun waiting to happen.
+    {
+        Config c;
+        c.scenario = "filterAutomation";
+        c.order = defaultOrder;
+        c.automateFilters = true;
+        c.mustNotAllocate = true;
+        c.seconds = 10.0;
+        configs.push_back(c);
+    }
+    
+    //the editor's spectrum analysis running: the audio thread only pays for copying the block into the ring
+    {
+        Config c;
+        c.scenario = "spectrumAnalysis";
+        c.order = defaultOrder;
+        c.spectrumAnalysis = true;
+        c.seconds = settings.secondsPerRun;
+        configs.push_back(c);
+    }
+    
+    //one instance with its editor closed and open: with nothing subscribed the meters, loudness and spectrum are skipped
+    for( auto editorOpen : { false, true } )
+    {
+        Config c;
+        c.scenario = "editor";
+        c.order = defaultOrder;
+        c.editorOpen = editorOpen;
+        c.seconds = settings.secondsPerRun;
+        configs.push_back(c);
+    }
+    
+    //the editor open with both analyzer traces tapped inside the chain: two extra copies per block
+    {
+        Config c;
+        c.scenario = "stageTaps";
+        c.order = defaultOrder;
+        c.editorOpen = true;
+        c.stageTaps = true;
+        c.seconds = settings.secondsPerRun;
+        configs.push_back(c);
+    }
+    
+    //the same sweep as timestamped events, which split every block into 4 segments
+    {
+        Config c;
+        c.scenario = "sampleAccurateAutomation";
+        c.order = defaultOrder;
+        c.automationEvents = true;
+        c.mustNotAllocate = true;
+        c.seconds = 10.0;
+        configs.push_back(c);
+    }
+
+    juce::Array<juce::var> runs;
+    totalAllocations = 0;
+    numFailedRuns = 0;
+    for( size_t i = 0; i < configs.size(); ++i )
+    {
+        const auto& c = configs[i];
+        std::cerr << "[" << (i + 1) << "/" << configs.size() << "] " << c.scenario
+                  << " " << c.layout.getDescription() << " " << c.sampleRate << "Hz " << c.blockSize << " samples" << std::endl;
+        runs.add(runConfig(c));
+    }
+
+    auto overdriveKernels = runOverdriveKernels();
+    auto channelLanesKernels = runChannelLanesKernels();
+    auto loudness = runLoudnessMeter();
+
+    auto* root = new juce::DynamicObject();
+    root->setProperty("version", ProjectInfo::versionString);
+    root->setProperty("timestamp", juce::Time::getCurrentTime().toISO8601(true));
+    root->setProperty("cpu", juce::SystemStats::getCpuModel());
+    root->setProperty("numCpus", juce::SystemStats::getNumCpus());
+    root->setProperty("os", juce::SystemStats::getOperatingSystemName());
+    root->setProperty("stageProfiling", VOX_STAGE_PROFILING != 0);
+    root->setProperty("material", settings.inputFile == juce::File() ? juce::String("synthetic vocal")
+                                                                     : settings.inputFile.getFileName());
+    root->setProperty("allocationsInProcessBlock", totalAllocations);
+    root->setProperty("failedRuns", numFailedRuns);
+    root->setProperty("runs", runs);
+    root->setProperty("overdriveKernels", overdriveKernels);
+    root->setProperty("channelLanesKernels", channelLanesKernels);
+    root->setProperty("loudness", loudness);
+
+    auto json = juce::JSON::toString(juce::var(root));
+    if( settings.outputFile == juce::File() )
+        std::cout << json << std::endl;
+    else if( ! settings.outputFile.replaceWithText(json) )
+        std::cerr << "could not write " << settings.outputFile.getFullPathName() << std::endl;
+
+    if( totalAllocations > 0 )
+        std::cerr << "processBlock() allocated " << totalAllocations << " times" << std::endl;
+
+    if( numFailedRuns > 0 )
+        return 1;
+
+    return settings.failOnAllocation && totalAllocations > 0 ? 1 : 0;
+}
+
+juce::var Benchmark::runConfig(const Config& config)
+{
+    using ProfiledStage = VoxProcessorAudioProcessor::ProfiledStage;
+    constexpr auto numStages = static_cast<size_t>(ProfiledStage::END_OF_LIST);
+
+    auto* result = new juce::DynamicObject();
+    result->setProperty("scenario", config.scenario);
+    result->setProperty("layout", config.layout.getDescription());
+    result->setProperty("numChannels", config.layout.size());
+    result->setProperty("sampleRate", config.sampleRate);
+    result->setProperty("blockSize", config.blockSize);
+
+    VoxProcessorAudioProcessor processor;
+    juce::AudioProcessor::BusesLayout layout;
+    layout.inputBuses.add(config.layout);
+    layout.outputBuses.add(config.layout);
+    if( ! processor.setBusesLayout(layout) )
+    {
+        std::cerr << config.layout.getDescription() << " was refused" << std::endl;
+        ++numFailedRuns;
+        result->setProperty("error", "layout not supported");
+        return result;
+    }
+
+    processor.setRateAndBufferSizeDetails(config.sampleRate, config.blockSize);
+    processor.setDspOrder(config.order);
+
+    auto bypassParams = std::array
+    {
+        processor.phaserBypass,
+        processor.chorusBypass,
+        processor.overdriveBypass,
+        processor.ladderFilterBypass,
+        processor.generalFilterBypass,
+    };
+    static_assert(bypassParams.size() == numOptions);
+    for( size_t i = 0; i < numOptions; ++i )
+        bypassParams[i]->setValueNotifyingHost(config.bypassed[i] ? 1.f : 0.f);
+
+    for( auto* param : { processor.overdriveOversampling, processor.ladderFilterOversampling } )
+        param->setValueNotifyingHost(param->convertTo0to1(static_cast<float>(config.oversampling)));
+
+    if( config.stageTaps )
+    {
+        using AnalysisTap = VoxProcessorAudioProcessor::AnalysisTap;
+        auto setTap = [](juce::AudioParameterChoice* param, AnalysisTap tap)
+        {
+            param->setValueNotifyingHost(param->convertTo0to1(static_cast<float>(tap)));
+        };
+        setTap(processor.analyzerTapA, AnalysisTap::LadderFilter);
+        setTap(processor.analyzerTapB, AnalysisTap::GeneralFilter);
+    }
+
+    processor.setControlBlockSize(config.controlBlockSize, config.adaptiveControlRate);
+    processor.prepareToPlay(config.sampleRate, config.blockSize);
+    result->setProperty("controlBlockSize", config.controlBlockSize);
+    result->setProperty("adaptiveControlRate", config.adaptiveControlRate);
+    result->setProperty("spectrumAnalysis", config.spectrumAnalysis);
+    result->setProperty("editorOpen", config.editorOpen);
+    result->setProperty("stageTaps", config.stageTaps);
+    
+    using AnalysisFeed = VoxProcessorAudioProcessor::AnalysisFeed;
+    std::vector<VoxProcessorAudioProcessor::AnalysisSubscription> subscriptions;
+    if( config.spectrumAnalysis || config.editorOpen )
+        subscriptions.push_back(processor.subscribe(AnalysisFeed::Spectrum));
+    if( config.editorOpen )
+    {
+        subscriptions.push_back(processor.subscribe(AnalysisFeed::LevelMeters));
+        subscriptions.push_back(processor.subscribe(AnalysisFeed::Loudness));
+    }
+    result->setProperty("oversampling", VoxDSP::StageOversampling::getModeNames()[static_cast<int>(config.oversampling)]);
+    result->setProperty("latencySamples", processor.getLatencySamples());
+    result->setProperty("tailSeconds", processor.getTailLengthSeconds());
+
+    const auto& material = getMaterial(config.sampleRate);
+    const auto blockSize = config.blockSize;
+    const auto numBlocks = juce::jmax(1, static_cast<int>(config.seconds * config.sampleRate / blockSize));
+    const auto numWarmupBlocks = juce::jmax(1, static_cast<int>(0.1 * config.sampleRate / blockSize));
+    const auto ticksToNs = 1.0e9 / static_cast<double>(juce::Time::getHighResolutionTicksPerSecond());
+
+    juce::AudioBuffer<float> buffer(config.layout.size(), blockSize);
+    juce::MidiBuffer midi;
+
+    std::vector<double> blockNs;
+    blockNs.reserve(static_cast<size_t>(numBlocks));
+    std::array<std::vector<double>, numStages> stageNs;
+    for( auto& v : stageNs )
+        v.reserve(static_cast<size_t>(numBlocks));
+
+    juce::int64 allocations = 0;
+    int materialPosition = 0;
+    bool outputIsFinite = true;
+
+    for( int b = -numWarmupBlocks; b < numBlocks; ++b )
+    {
+        if( materialPosition + blockSize > material.getNumSamples() )
+            materialPosition = 0;
+
+        for( int ch = 0; ch < buffer.getNumChannels(); ++ch )
+            buffer.copyFrom(ch, 0, material, ch % material.getNumChannels(), materialPosition, blockSize);
+        materialPosition += blockSize;
+
+        if( config.silentInput && b >= 0 )
+            buffer.clear();
+
+        if( config.automateFilters )
+        {
+            //log sweep from 200Hz to 8kHz and back every 2 seconds
+            auto t = static_cast<double>(b) * blockSize / config.sampleRate;
+            auto lfo = 0.5 + 0.5 * std::sin(juce::MathConstants<double>::twoPi * 0.5 * t);
+            auto hz = static_cast<float>(200.0 * std::pow(40.0, lfo));
+            processor.generalFilterFreqHz->setValueNotifyingHost(processor.generalFilterFreqHz->convertTo0to1(hz));
+            processor.ladderFilterCutoffHz->setValueNotifyingHost(processor.ladderFilterCutoffHz->convertTo0to1(hz));
+        }
+        
+        if( config.automationEvents )
+        {
+            for( int k = 0; k < 4; ++k )
+            {
+                auto offset = k * blockSize / 4;
+                auto t = static_cast<double>(b * blockSize + offset) / config.sampleRate;
+                auto lfo = 0.5 + 0.5 * std::sin(juce::MathConstants<double>::twoPi * 0.5 * t);
+                auto hz = static_cast<float>(200.0 * std::pow(40.0, lfo));
+                processor.addParameterEvent(offset, processor.generalFilterFreqHz, hz);
+                processor.addParameterEvent(offset, processor.ladderFilterCutoffHz, hz);
+            }
+        }
+
+        juce::int64 start, end, allocationsThisBlock;
+        {
+            ScopedAllocationCounter counter;
+            start = juce::Time::getHighResolutionTicks();
+            processor.processBlock(buffer, midi);
+            end = juce::Time::getHighResolutionTicks();
+            allocationsThisBlock = counter.getCount();
+        }
+
+        if( b < 0 )
+            continue;
+
+        for( int ch = 0; ch < buffer.getNumChannels(); ++ch )
+        {
+            const auto* samples = buffer.getReadPointer(ch);
+            outputIsFinite &= std::all_of(samples, samples + blockSize, [](float x) { return std::isfinite(x); });
+        }
+
+        allocations += allocationsThisBlock;
+        blockNs.push_back(static_cast<double>(end - start) * ticksToNs);
+
+        const auto& ticks = processor.getLastBlockStageTicks();
+        for( size_t s = 0; s < numStages; ++s )
+            stageNs[s].push_back(static_cast<double>(ticks[s]) * ticksToNs);
+    }
+
+    subscriptions.clear();
+    processor.releaseResources();
+    totalAllocations += allocations;
+
+    const auto numSamples = static_cast<double>(numBlocks) * blockSize;
+    const auto cpuSeconds = std::accumulate(blockNs.begin(), blockNs.end(), 0.0) * 1.0e-9;
+
+    if( ! outputIsFinite )
+    {
+        std::cerr << config.layout.getDescription() << " produced NaN or inf" << std::endl;
+        ++numFailedRuns;
+        result->setProperty("error", "output not finite");
+    }
+    
+    if( config.mustNotAllocate && allocations > 0 )
+    {
+        std::cerr << config.scenario << ": processBlock() allocated " << allocations << " times" << std::endl;
+        ++numFailedRuns;
+        result->setProperty("error", "processBlock() allocated");
+    }
+
+    juce::Array<juce::var> order, bypassed;
+    for( size_t i = 0; i < numOptions; ++i )
+    {
+        order.add(getOptionName(config.order[i]));
+        if( config.bypassed[i] )
+            bypassed.add(getOptionName(static_cast<DSP_Option>(i)));
+    }
+    result->setProperty("order", order);
+    result->setProperty("bypassed", bypassed);
+
+    result->setProperty("realtimeFactor", numSamples / config.sampleRate / juce::jmax(cpuSeconds, 1.0e-12));
+    result->setProperty("allocations", allocations);
+    result->setProperty("block", summarise(blockNs, numSamples));
+
+    auto* stages = new juce::DynamicObject();
+    for( size_t s = 0; s < numStages; ++s )
+        stages->setProperty(getStageName(static_cast<ProfiledStage>(s)), summarise(stageNs[s], numSamples));
+    result->setProperty("stages", stages);
+
+    return result;
+}
+
+/*
+ The overdrive stage on its own: the ladder filter it used to be, pinned at 20kHz, against every waveshaper curve
+ with and without ADAA. Stereo material at 48k/512, with the drive swept over its whole range once a second.
+ */
+juce::var Benchmark::runOverdriveKernels()
+{
+    constexpr double sampleRate = 48000.0;
+    constexpr int blockSize = 512;
+    constexpr int numChannels = 2;
+
+    const auto& material = getMaterial(sampleRate);
+    const auto numBlocks = juce::jmax(1, static_cast<int>(settings.secondsPerRun * sampleRate / blockSize));
+    const auto ticksToNs = 1.0e9 / static_cast<double>(juce::Time::getHighResolutionTicksPerSecond());
+    const juce::dsp::ProcessSpec spec { sampleRate, static_cast<juce::uint32>(blockSize), static_cast<juce::uint32>(numChannels) };
+
+    juce::AudioBuffer<float> buffer(numChannels, blockSize);
+    bool outputIsFinite = true;
+
+    //returns ns per sample
+    auto time = [&](auto&& process)
+    {
+        juce::int64 ticks = 0;
+        int materialPosition = 0;
+        for( int b = 0; b < numBlocks; ++b )
+        {
+            if( materialPosition + blockSize > material.getNumSamples() )
+                materialPosition = 0;
+
+            for( int ch = 0; ch < numChannels; ++ch )
+                buffer.copyFrom(ch, 0, material, ch % material.getNumChannels(), materialPosition, blockSize);
+            materialPosition += blockSize;
+
+            auto t = static_cast<double>(b) * blockSize / sampleRate;
+            auto drive = static_cast<float>(1.0 + 99.0 * (0.5 + 0.5 * std::sin(juce::MathConstants<double>::twoPi * t)));
+
+            auto block = juce::dsp::AudioBlock<float>(buffer);
+            auto start = juce::Time::getHighResolutionTicks();
+            process(block, drive);
+            ticks += juce::Time::getHighResolutionTicks() - start;
+
+            for( int ch = 0; ch < numChannels; ++ch )
+            {
+                const auto* samples = buffer.getReadPointer(ch);
+                outputIsFinite &= std::all_of(samples, samples + blockSize, [](float x) { return std::isfinite(x); });
+            }
+        }
+        return static_cast<double>(ticks) * ticksToNs / (static_cast<double>(numBlocks) * blockSize);
+    };
+
+    juce::dsp::LadderFilter<float> ladder;
+    ladder.prepare(spec);
+    const auto ladderNs = time([&](juce::dsp::AudioBlock<float>& block, float drive)
+    {
+        ladder.setDrive(drive);
+        ladder.setCutoffFrequencyHz(20000.f);
+        ladder.process(juce::dsp::ProcessContextReplacing<float>(block));
+    });
+
+    juce::Array<juce::var> kernels;
+    auto addKernel = [&](const juce::String& name, double ns)
+    {
+        auto* obj = new juce::DynamicObject();
+        obj->setProperty("kernel", name);
+        obj->setProperty("nsPerSample", ns);
+        obj->setProperty("speedupVsLadder", ladderNs / juce::jmax(ns, 1.0e-12));
+        kernels.add(obj);
+        std::cerr << "overdrive " << name << ": " << ns << " ns/sample, " << ladderNs / juce::jmax(ns, 1.0e-12) << "x the ladder" << std::endl;
+    };
+    addKernel("ladder", ladderNs);
+
+    const auto curveNames = VoxDSP::Waveshaper::getCurveNames();
+    for( int curve = 0; curve < static_cast<int>(VoxDSP::Waveshaper::Curve::END_OF_LIST); ++curve )
+    {
+        for( auto adaa : { false, true } )
+        {
+            VoxDSP::Waveshaper shaper;
+            shaper.prepare(spec);
+            shaper.setCurve(static_cast<VoxDSP::Waveshaper::Curve>(curve));
+            shaper.setAntiderivativeAntialiasing(adaa);
+
+            addKernel(curveNames[curve] + (adaa ? " ADAA" : ""), time([&](juce::dsp::AudioBlock<float>& block, float drive)
+            {
+                shaper.setDrive(drive);
+                shaper.process(juce::dsp::ProcessContextReplacing<float>(block));
+            }));
+        }
+    }
+
+    if( ! outputIsFinite )
+    {
+        std::cerr << "an overdrive kernel produced NaN or inf" << std::endl;
+        ++numFailedRuns;
+    }
+
+    return kernels;
+}
+
+/*
+ The filters that run their channels in SIMD lanes against their JUCE counterparts, which run one channel at a time:
+ the ladder against juce::dsp::LadderFilter, the general filter's bandpass against juce::dsp::StateVariableTPTFilter.
+ Static settings, so only the per sample work is compared, on stereo and on 8 channels at 48k/512.
+ A speedup below 1 fails the run.
+ */
+juce::var Benchmark::runChannelLanesKernels()
+{
+    constexpr double sampleRate = 48000.0;
+    constexpr int blockSize = 512;
+
+    const auto& material = getMaterial(sampleRate);
+    const auto numBlocks = juce::jmax(1, static_cast<int>(settings.secondsPerRun * sampleRate / blockSize));
+    const auto ticksToNs = 1.0e9 / static_cast<double>(juce::Time::getHighResolutionTicksPerSecond());
+
+    juce::Array<juce::var> kernels;
+    for( int numChannels : { 2, 8 } )
+    {
+        const juce::dsp::ProcessSpec spec { sampleRate, static_cast<juce::uint32>(blockSize), static_cast<juce::uint32>(numChannels) };
+        juce::AudioBuffer<float> buffer(numChannels, blockSize);
+
+        //returns ns per sample and channel
+        auto time = [&](auto&& process)
+        {
+            juce::int64 ticks = 0;
+            int materialPosition = 0;
+            for( int b = 0; b < numBlocks; ++b )
+            {
+                if( materialPosition + blockSize > material.getNumSamples() )
+                    materialPosition = 0;
+
+                for( int ch = 0; ch < numChannels; ++ch )
+                    buffer.copyFrom(ch, 0, material, ch % material.getNumChannels(), materialPosition, blockSize);
+                materialPosition += blockSize;
+
+                auto block = juce::dsp::AudioBlock<float>(buffer);
+                auto start = juce::Time::getHighResolutionTicks();
+                process(juce::dsp::ProcessContextReplacing<float>(block));
+                ticks += juce::Time::getHighResolutionTicks() - start;
+            }
+            return static_cast<double>(ticks) * ticksToNs / (static_cast<double>(numBlocks) * blockSize * numChannels);
+        };
+
+        auto addKernel = [&](const juce::String& name, double scalarNs, double lanesNs)
+        {
+            const auto speedup = scalarNs / juce::jmax(lanesNs, 1.0e-12);
+            auto* obj = new juce::DynamicObject();
+            obj->setProperty("kernel", name);
+            obj->setProperty("numChannels", numChannels);
+            obj->setProperty("scalarNsPerSample", scalarNs);
+            obj->setProperty("lanesNsPerSample", lanesNs);
+            obj->setProperty("speedup", speedup);
+            kernels.add(obj);
+            std::cerr << name << " " << numChannels << " channels: " << scalarNs << " ns/sample one channel at a time, "
+                      << lanesNs << " ns/sample in lanes, " << speedup << "x" << std::endl;
+
+            if( speedup < 1.0 )
+            {
+                std::cerr << name << " is slower in lanes than one channel at a time" << std::endl;
+                ++numFailedRuns;
+            }
+        };
+
+        {
+            juce::dsp::LadderFilter<float> scalar;
+            scalar.prepare(spec);
+            scalar.setMode(juce::dsp::LadderFilterMode::LPF24);
+            scalar.setCutoffFrequencyHz(1000.f);
+            scalar.setResonance(0.5f);
+            scalar.setDrive(4.f);
+
+            VoxDSP::LadderFilter lanes;
+            lanes.prepare(spec);
+            lanes.setMode(juce::dsp::LadderFilterMode::LPF24);
+            lanes.setCutoffFrequencyHz(1000.f);
+            lanes.setResonance(0.5f);
+            lanes.setDrive(4.f);
+
+            addKernel("ladderFilter",
+                      time([&](const auto& context) { scalar.process(context); }),
+                      time([&](const auto& context) { lanes.process(context); }));
+        }
+
+        {
+            juce::dsp::StateVariableTPTFilter<float> scalar;
+            scalar.prepare(spec);
+            scalar.setType(juce::dsp::StateVariableTPTFilterType::bandpass);
+            scalar.setCutoffFrequency(1000.f);
+            scalar.setResonance(2.f);
+
+            VoxDSP::GeneralFilter lanes;
+            lanes.prepare(spec);
+            lanes.setParameters(VoxDSP::GeneralFilterMode::Bandpass, 1000.f, 2.f, 0.f);
+
+            addKernel("generalFilter",
+                      time([&](const auto& context) { scalar.process(context); }),
+                      time([&](const auto& context) { lanes.process(context); }));
+        }
+    }
+
+    return kernels;
+}
+
+/*
+ The cost of the BS.1770 loudness meter on one stereo output at 48k/512.
+ It runs on the audio thread for every instance, so it has to stay well under 1% of a core.
+ */
+juce::var Benchmark::runLoudnessMeter()
+{
+    constexpr double sampleRate = 48000.0;
+    constexpr int blockSize = 512;
+    constexpr double maxCoreLoadPercent = 1.0;
+
+    const auto& material = getMaterial(sampleRate);
+    const auto numBlocks = juce::jmax(1, static_cast<int>(settings.secondsPerRun * sampleRate / blockSize));
+    const auto ticksToNs = 1.0e9 / static_cast<double>(juce::Time::getHighResolutionTicksPerSecond());
+
+    juce::AudioBuffer<float> buffer(2, blockSize);
+    VoxDSP::LoudnessMeter meter;
+    meter.prepare(sampleRate, juce::AudioChannelSet::stereo());
+
+    juce::int64 ticks = 0;
+    int materialPosition = 0;
+    for( int b = 0; b < numBlocks; ++b )
+    {
+        if( materialPosition + blockSize > material.getNumSamples() )
+            materialPosition = 0;
+
+        for( int ch = 0; ch < 2; ++ch )
+            buffer.copyFrom(ch, 0, material, ch % material.getNumChannels(), materialPosition, blockSize);
+        materialPosition += blockSize;
+
+        auto block = juce::dsp::AudioBlock<const float>(buffer);
+        auto start = juce::Time::getHighResolutionTicks();
+        meter.process(block);
+        ticks += juce::Time::getHighResolutionTicks() - start;
+    }
+
+    const auto nsPerSample = static_cast<double>(ticks) * ticksToNs / (static_cast<double>(numBlocks) * blockSize);
+    const auto coreLoadPercent = nsPerSample * sampleRate * 1.0e-7; //ns of work per second of audio, as a percentage
+
+    meter.pullSnapshot();
+    const auto& snapshot = meter.getSnapshot();
+
+    auto* obj = new juce::DynamicObject();
+    obj->setProperty("nsPerSample", nsPerSample);
+    obj->setProperty("coreLoadPercent", coreLoadPercent);
+    obj->setProperty("integratedLufs", std::isfinite(snapshot.integratedLufs) ? snapshot.integratedLufs : -999.f);
+    obj->setProperty("loudnessRangeLu", snapshot.loudnessRangeLu);
+
+    std::cerr << "loudness meter: " << nsPerSample << " ns/sample, " << coreLoadPercent << "% of a core, "
+              << snapshot.integratedLufs << " LUFS integrated, LRA " << snapshot.loudnessRangeLu << " LU" << std::endl;
+
+    if( coreLoadPercent >= maxCoreLoadPercent )
+    {
+        std::cerr << "the loudness meter costs more than " << maxCoreLoadPercent << "% of a core" << std::endl;
+        ++numFailedRuns;
+    }
+
+    return obj;
+}
+
+/*
+ The processor plays the material in real time while its editor gets a frame at every 60Hz refresh,
+ the way the vblank callback drives it, and is then painted whole into a software image.
+ Frames are paced on the wall clock, so a frame whose work overruns its refresh shows up as dropped.
+ */
+int Benchmark::runGuiFrameStats()
+{
+    constexpr double sampleRate = 48000.0;
+    constexpr int blockSize = 512;
+    constexpr double refreshIntervalMs = 1000.0 / 60.0;
+
+    VoxProcessorAudioProcessor processor;
+    processor.setRateAndBufferSizeDetails(sampleRate, blockSize);
+    processor.prepareToPlay(sampleRate, blockSize);
+
+    //both analyzer traces on screen
+    using AnalysisTap = VoxProcessorAudioProcessor::AnalysisTap;
+    processor.analyzerTapB->setValueNotifyingHost(processor.analyzerTapB->convertTo0to1(static_cast<float>(AnalysisTap::LadderFilter)));
+
+    auto* root = new juce::DynamicObject();
+    root->setProperty("version", ProjectInfo::versionString);
+    root->setProperty("timestamp", juce::Time::getCurrentTime().toISO8601(true));
+    root->setProperty("cpu", juce::SystemStats::getCpuModel());
+    root->setProperty("os", juce::SystemStats::getOperatingSystemName());
+    root->setProperty("material", settings.inputFile == juce::File() ? juce::String("synthetic vocal")
+                                                                     : settings.inputFile.getFileName());
+    root->setProperty("renderer", "software");
+    root->setProperty("refreshHz", 1000.0 / refreshIntervalMs);
+
+    const auto numFrames = juce::jmax(1, static_cast<int>(settings.secondsPerRun * 1000.0 / refreshIntervalMs));
+    auto failed = false;
+    {
+        //the editor subscribes to the meters, loudness and spectrum, as it does in a host
+        VoxProcessorAudioProcessorEditor editor(processor);
+        editor.setFrameStatsVisible(true);
+        root->setProperty("width", editor.getWidth());
+        root->setProperty("height", editor.getHeight());
+
+        juce::Image image(juce::Image::ARGB, editor.getWidth(), editor.getHeight(), true, juce::SoftwareImageType());
+        const auto& material = getMaterial(sampleRate);
+        juce::AudioBuffer<float> buffer(juce::jmax(processor.getTotalNumInputChannels(), processor.getTotalNumOutputChannels()), blockSize);
+        juce::MidiBuffer midi;
+        int materialPosition = 0;
+        double samplesDue = 0.0;
+
+        const auto startMs = juce::Time::getMillisecondCounterHiRes();
+        for( int f = 0; f < numFrames; ++f )
+        {
+            //the audio that plays during one refresh
+            for( samplesDue += sampleRate * refreshIntervalMs / 1000.0; samplesDue >= blockSize; samplesDue -= blockSize )
+            {
+                if( materialPosition + blockSize > material.getNumSamples() )
+                    materialPosition = 0;
+
+                for( int ch = 0; ch < buffer.getNumChannels(); ++ch )
+                    buffer.copyFrom(ch, 0, material, ch % material.getNumChannels(), materialPosition, blockSize);
+                materialPosition += blockSize;
+
+                processor.processBlock(buffer, midi);
+            }
+
+            //sleep through most of the wait for the next refresh, yield through the last of it
+            const auto dueMs = startMs + f * refreshIntervalMs;
+            for( auto nowMs = juce::Time::getMillisecondCounterHiRes(); nowMs < dueMs; nowMs = juce::Time::getMillisecondCounterHiRes() )
+            {
+                if( dueMs - nowMs > 2.0 )
+                    juce::Thread::sleep(1);
+                else
+                    juce::Thread::yield();
+            }
+
+            editor.renderFrame(juce::Time::getMillisecondCounterHiRes());
+            juce::Graphics g(image);
+            editor.paintEntireComponent(g, false);
+        }
+
+        //every display is painted whole every frame here, so every one of them must have been timed every frame
+        const auto& stats = editor.getFrameStats();
+        failed = stats.getNumFrames() != numFrames;
+        for( auto source : { FrameStats::Source::InputMeter, FrameStats::Source::OutputMeter,
+                             FrameStats::Source::Loudness, FrameStats::Source::Analyzer } )
+        {
+            if( stats.getTimes(source).count != numFrames )
+            {
+                std::cerr << FrameStats::getName(source) << " was timed " << stats.getTimes(source).count
+                          << " times in " << numFrames << " frames" << std::endl;
+                failed = true;
+            }
+        }
+
+        root->setProperty("frameStats", stats.toVar());
+    }
+    processor.releaseResources();
+
+    auto json = juce::JSON::toString(juce::var(root));
+    if( settings.outputFile == juce::File() )
+        std::cout << json << std::endl;
+    else if( ! settings.outputFile.replaceWithText(json) )
+        std::cerr << "could not write " << settings.outputFile.getFullPathName() << std::endl;
+
+    return failed ? 1 : 0;
+}
+
+//==============================================================================
+const juce::AudioBuffer<float>& Benchmark::getMaterial(double sampleRate)
+{
+    auto it = materialCache.find(sampleRate);
+    if( it != materialCache.end() )
+        return it->second;
+
+    //at least one of the biggest blocks, so short runs still see real material
+    auto seconds = juce::jmax(settings.secondsPerRun, 4096.0 / sampleRate);
+    auto material = settings.inputFile == juce::File() ? makeSyntheticVocal(sampleRate, seconds)
+                                                       : loadRecordedMaterial(sampleRate, seconds);
+    return materialCache.emplace(sampleRate, std::move(material)).first->second;
+}
+
+/*
+ A sung line: a note every half second with 5.5Hz vibrato, harmonics shaped by three vowel formants,
+ breath noise, and a short pause at the end of every two second phrase.
+ The seed is fixed so every run and every release sees the same samples.
+ */
+juce::AudioBuffer<float> Benchmark::makeSyntheticVocal(double sampleRate, double seconds) const
+{
+    const auto numSamples = static_cast<int>(std::ceil(seconds * sampleRate));
+    juce::AudioBuffer<float> material(2, numSamples);
+
+    const double notes[] = { 220.0, 246.94, 261.63, 293.66, 329.63, 293.66, 261.63, 196.0 };
+    const double formants[] = { 700.0, 1220.0, 2600.0 };
+    const double formantWidths[] = { 130.0, 170.0, 250.0 };
+    const auto twoPi = juce::MathConstants<double>::twoPi;
+    const auto maxHarmonicHz = juce::jmin(12000.0, sampleRate * 0.45);
+
+    juce::Random random(0x566f78);
+    double phase = 0.0;
+    auto* left = material.getWritePointer(0);
+
+    for( int i = 0; i < numSamples; ++i )
+    {
+        auto t = static_cast<double>(i) / sampleRate;
+        auto note = notes[static_cast<size_t>(t / 0.5) % std::size(notes)];
+        auto f0 = note * std::pow(2.0, 0.3 / 12.0 * std::sin(twoPi * 5.5 * t));
+        phase += f0 / sampleRate;
+        phase -= std::floor(phase);
+
+        //20ms fades at the note edges, silence for the last 300ms of every phrase
+        auto positionInNote = std::fmod(t, 0.5);
+        auto envelope = juce::jmin(1.0, positionInNote / 0.02, (0.5 - positionInNote) / 0.02);
+        if( std::fmod(t, 2.0) > 1.7 )
+            envelope = 0.0;
+
+        double sample = 0.0;
+        if( envelope > 0.0 )
+        {
+            for( int h = 1; h * f0 < maxHarmonicHz; ++h )
+            {
+                auto hz = h * f0;
+                double gain = 0.0;
+                for( size_t f = 0; f < std::size(formants); ++f )
+                {
+                    auto d = (hz - formants[f]) / formantWidths[f];
+                    gain += std::exp(-0.5 * d * d);
+                }
+                sample += (gain + 0.05) / h * std::sin(twoPi * h * phase);
+            }
+        }
+
+        auto breath = (random.nextFloat() * 2.f - 1.f) * 0.003f;
+        left[i] = static_cast<float>(0.25 * envelope * sample) + breath;
+    }
+
+    //the right channel is the same voice a little later, like a second mic
+    const auto offset = juce::jmin(numSamples, static_cast<int>(sampleRate * 0.0003));
+    material.clear(1, 0, offset);
+    material.copyFrom(1, offset, material, 0, 0, numSamples - offset);
+
+    material.applyGain(0.5f / juce::jmax(material.getMagnitude(0, numSamples), 1.0e-6f));
+    return material;
+}
+
+juce::AudioBuffer<float> Benchmark::loadRecordedMaterial(double sampleRate, double seconds) const
+{
+    juce::AudioFormatManager formatManager;
+    formatManager.registerBasicFormats();
+    std::unique_ptr<juce::AudioFormatReader> reader (formatManager.createReaderFor(settings.inputFile));
+    if( reader == nullptr || reader->lengthInSamples == 0 )
+    {
+        std::cerr << "could not read " << settings.inputFile.getFullPathName() << ", using the synthetic vocal" << std::endl;
+        return makeSyntheticVocal(sampleRate, seconds);
+    }
+
+    juce::AudioBuffer<float> file(2, static_cast<int>(reader->lengthInSamples));
+    reader->read(&file, 0, file.getNumSamples(), 0, true, true);
+
+    //resample to the rate under test and loop the file until there is enough of it
+    const auto numSamples = static_cast<int>(std::ceil(seconds * sampleRate));
+    const auto speedRatio = reader->sampleRate / sampleRate;
+    juce::AudioBuffer<float> material(2, numSamples);
+
+    for( int ch = 0; ch < 2; ++ch )
+    {
+        juce::LagrangeInterpolator interpolator;
+        const auto* in = file.getReadPointer(ch);
+        auto* out = material.getWritePointer(ch);
+        int inPos = 0;
+        int outPos = 0;
+        while( outPos < numSamples )
+        {
+            auto numOut = juce::jmin(numSamples - outPos,
+                                     static_cast<int>((file.getNumSamples() - inPos) / speedRatio) - 4);
+            if( numOut <= 0 )
+            {
+                inPos = 0;
+                interpolator.reset();
+                continue;
+            }
+
+            inPos += interpolator.process(speedRatio, in + inPos, out + outPos, numOut);
+            outPos += numOut;
+        }
+    }
+
+    return material;
+}
@@ -0,0 +1,89 @@
+/*
+  ==============================================================================
+
+    Benchmark.h
+    Created: 16 Oct 2026 3:02:26pm
+    Author:  Morris Sound
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "../VoxProcessor/Source/PluginProcessor.h"
+
+/*
+ Reproducible processBlock() benchmark.
+ Every run builds a fresh processor for one configuration (bus layout, sample rate, block size, dsp order, bypass states),
+ pushes the same material through it and records the time of every block, overall and per stage.
+ The results are written as JSON so they can be diffed between releases.
+ Per stage numbers need the project to be built with VOX_STAGE_PROFILING=1 (VoxRender is).
+ */
+struct Benchmark
+{
+    struct Settings
+    {
+        juce::File inputFile;       //recorded material, synthetic vocal when empty
+        juce::File outputFile;      //stdout when empty
+        double secondsPerRun = 2.0;
+        juce::Array<int> blockSizes { 16, 32, 64, 128, 256, 512, 1024, 2048, 4096 };
+        juce::Array<double> sampleRates { 44100.0, 48000.0, 88200.0, 96000.0, 192000.0 };
+        bool allOrders = true;      //every permutation of DSP_Option at 48k/512
+        bool allBypassStates = true;//every bypass combination at 48k/512
+        bool exhaustive = false;    //every order crossed with every bypass combination
+        bool failOnAllocation = false; //every run, not only the ones marked mustNotAllocate
+    };
+
+    using DSP_Option = VoxProcessorAudioProcessor::DSP_Option;
+    using DSP_Order = VoxProcessorAudioProcessor::DSP_Order;
+    using OversamplingMode = VoxProcessorAudioProcessor::OversamplingMode;
+    static constexpr size_t numOptions = static_cast<size_t>(DSP_Option::END_OF_LIST);
+
+    struct Config
+    {
+        juce::String scenario;
+        double sampleRate = 48000.0;
+        int blockSize = 512;
+        DSP_Order order;
+        std::array<bool, numOptions> bypassed {};
+        juce::AudioChannelSet layout = juce::AudioChannelSet::stereo();
+        bool automateFilters = false;
+        bool automationEvents = false; //the filter automation as sample accurate events, 4 per block
+        OversamplingMode oversampling = OversamplingMode::Off; //overdrive and ladder filter
+        bool silentInput = false;   //material during the warmup only, then silence
+        int controlBlockSize = VoxProcessorAudioProcessor::defaultControlBlockSize;
+        bool adaptiveControlRate = true;
+        bool spectrumAnalysis = false; //the spectrum feed subscribed
+        bool editorOpen = false;       //every analysis feed subscribed, as the editor does
+        bool stageTaps = false;        //the analyzer traces after the ladder and the general filter, instead of output and off
+        bool mustNotAllocate = false;  //an allocation in processBlock() fails the run
+        double seconds = 2.0;
+    };
+
+    explicit Benchmark(Settings s);
+
+    //Returns 0 on success, 1 when a layout couldn't be processed cleanly, when processBlock() allocated
+    //in a run marked mustNotAllocate, or when failOnAllocation is set and it allocated in any run.
+    int run();
+
+    //The editor offscreen on the software renderer for secondsPerRun, writes its FrameStats as JSON.
+    //Returns 1 when a display wasn't painted or timed every frame.
+    int runGuiFrameStats();
+
+    static DSP_Order getDefaultOrder();
+
+private:
+    juce::var runConfig(const Config& config);
+    juce::var runOverdriveKernels();
+    juce::var runChannelLanesKernels();
+    juce::var runLoudnessMeter();
+    const juce::AudioBuffer<float>& getMaterial(double sampleRate);
+    juce::AudioBuffer<float> makeSyntheticVocal(double sampleRate, double seconds) const;
+    juce::AudioBuffer<float> loadRecordedMaterial(double sampleRate, double seconds) const;
+
+    Settings settings;
+    std::map<double, juce::AudioBuffer<float>> materialCache;
+    juce::int64 totalAllocations = 0;
+    int numFailedRuns = 0;
+};
@@ -7,99 +7,130 @@
 */
 
 #include <JuceHeader.h>
-#include "MainComponent.h"
+#include "OfflineRenderer.h"
+#include "Benchmark.h"
+#include "../VoxProcessor/Source/PluginProcessor.h"
 
-//==============================================================================
-class VoxProcessorApplication  : public juce::JUCEApplication
+/*
+ Headless batch renderer for VoxProcessor.
+
+ VoxRender --input=<file or directory> --output=<directory> [--state=<file>] [--block-size=512] [--threads=N]
+ VoxRender --write-default-state=<file>
+ VoxRender --bench [--bench-output=<file>] [--input=<file>] [--seconds=2] [--block-sizes=16,...,4096]
+                   [--sample-rates=44100,...,192000] [--exhaustive] [--fail-on-allocation]
+ VoxRender --gui-frame-stats [--bench-output=<file>] [--input=<file>] [--seconds=2]
+
+ --state takes a blob written by VoxProcessorAudioProcessor::getStateInformation(),
+ --write-default-state writes one with the default settings to start from.
+ --bench times processBlock() over block sizes, sample rates, dsp orders and bypass states and writes JSON,
+ --input is then the material to use instead of the built in synthetic vocal.
+ --gui-frame-stats plays the material through the editor offscreen on the software renderer,
+ one frame per 60Hz refresh, and writes the editor's frame stats as JSON.
+ */
+static void printUsage()
 {
-public:
-    //==============================================================================
-    VoxProcessorApplication() {}
-
-    const juce::String getApplicationName() override       { return ProjectInfo::projectName; }
-    const juce::String getApplicationVersion() override    { return ProjectInfo::versionString; }
-    bool moreThanOneInstanceAllowed() override             { return true; }
+    std::cout << "usage:" << std::endl
+              << "  VoxRender --input=<file or directory> --output=<directory> [--state=<file>] [--block-size=512] [--threads=N]" << std::endl
+              << "  VoxRender --write-default-state=<file>" << std::endl
+              << "  VoxRender --bench [--bench-output=<file>] [--input=<file>] [--seconds=2] [--block-sizes=16,...,4096]" << std::endl
+              << "                    [--sample-rates=44100,...,192000] [--exhaustive] [--fail-on-allocation]" << std::endl
+              << "  VoxRender --gui-frame-stats [--bench-output=<file>] [--input=<file>] [--seconds=2]" << std::endl;
+}
+
+static juce::File getFileFromArgument(const juce::String& path)
+{
+    return juce::File::getCurrentWorkingDirectory().getChildFile(path.unquoted());
+}
 
-    //==============================================================================
-    void initialise (const juce::String& commandLine) override
+static int runBenchmark(const juce::ArgumentList& args)
+{
+    Benchmark::Settings settings;
+    if( args.containsOption("--bench-output") )
+        settings.outputFile = getFileFromArgument(args.getValueForOption("--bench-output"));
+    if( args.containsOption("--input") )
+        settings.inputFile = getFileFromArgument(args.getValueForOption("--input"));
+    if( args.containsOption("--seconds") )
+        settings.secondsPerRun = juce::jmax(0.01, args.getValueForOption("--seconds").getDoubleValue());
+
+    if( args.containsOption("--block-sizes") )
     {
-        // This method is where you should put your application's initialisation code..
+        settings.blockSizes.clear();
+        for( const auto& token : juce::StringArray::fromTokens(args.getValueForOption("--block-sizes"), ",", "") )
+            if( token.getIntValue() > 0 )
+                settings.blockSizes.add(token.getIntValue());
+    }
 
-        mainWindow.reset (new MainWindow (getApplicationName()));
+    if( args.containsOption("--sample-rates") )
+    {
+        settings.sampleRates.clear();
+        for( const auto& token : juce::StringArray::fromTokens(args.getValueForOption("--sample-rates"), ",", "") )
+            if( token.getDoubleValue() > 0.0 )
+                settings.sampleRates.add(token.getDoubleValue());
     }
 
-    void shutdown() override
+    settings.exhaustive = args.containsOption("--exhaustive");
+    settings.failOnAllocation = args.containsOption("--fail-on-allocation");
+
+    if( args.containsOption("--gui-frame-stats") )
+        return Benchmark(std::move(settings)).runGuiFrameStats();
+
+    return Benchmark(std::move(settings)).run();
+}
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    //the processor's parameter tree needs a message manager, even though we never run the message loop.
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+    juce::ArgumentList args (argc, argv);
+
+    if( args.containsOption("--write-default-state") )
     {
-        // Add your application's shutdown code here..
+        auto file = getFileFromArgument(args.getValueForOption("--write-default-state"));
+        VoxProcessorAudioProcessor processor;
+        juce::MemoryBlock state;
+        processor.getStateInformation(state);
 
-        mainWindow = nullptr; // (deletes our window)
+        if( ! file.replaceWithData(state.getData(), state.getSize()) )
+        {
+            std::cerr << "could not write " << file.getFullPathName() << std::endl;
+            return 1;
+        }
+        return 0;
     }
 
-    //==============================================================================
-    void systemRequestedQuit() override
+    if( args.containsOption("--bench") || args.containsOption("--gui-frame-stats") )
+        return runBenchmark(args);
+
+    if( ! args.containsOption("--input") || ! args.containsOption("--output") )
     {
-        // This is called when the app is being asked to quit: you can ignore this
-        // request and let the app carry on running, or call quit() to allow the app to close.
-        quit();
+        printUsage();
+        return 1;
     }
 
-    void anotherInstanceStarted (const juce::String& commandLine) override
+    OfflineRenderer::Settings settings;
+    settings.inputFiles = OfflineRenderer::findAudioFiles(getFileFromArgument(args.getValueForOption("--input")));
+    settings.outputDirectory = getFileFromArgument(args.getValueForOption("--output"));
+    settings.blockSize = args.containsOption("--block-size") ? args.getValueForOption("--block-size").getIntValue() : 512;
+    settings.numThreads = args.containsOption("--threads") ? args.getValueForOption("--threads").getIntValue()
+                                                           : juce::SystemStats::getNumCpus();
+
+    if( settings.inputFiles.isEmpty() )
     {
-        // When another instance of the app is launched while this one is running,
-        // this method is invoked, and the commandLine parameter tells you what
-        // the other instance's command-line arguments were.
+        std::cerr << "no audio files found" << std::endl;
+        return 1;
     }
 
-    //==============================================================================
-    /*
-        This class implements the desktop window that contains an instance of
-        our MainComponent class.
-    */
-    class MainWindow    : public juce::DocumentWindow
+    if( args.containsOption("--state") )
     {
-    public:
-        MainWindow (juce::String name)
-            : DocumentWindow (name,
-                              juce::Desktop::getInstance().getDefaultLookAndFeel()
-                                                          .findColour (juce::ResizableWindow::backgroundColourId),
-                              DocumentWindow::allButtons)
+        auto stateFile = getFileFromArgument(args.getValueForOption("--state"));
+        if( ! stateFile.loadFileAsData(settings.state) )
         {
-            setUsingNativeTitleBar (true);
-            setContentOwned (new MainComponent(), true);
-
-           #if JUCE_IOS || JUCE_ANDROID
-            setFullScreen (true);
-           #else
-            setResizable (true, true);
-            centreWithSize (getWidth(), getHeight());
-           #endif
-
-            setVisible (true);
+            std::cerr << "could not read " << stateFile.getFullPathName() << std::endl;
+            return 1;
         }
+    }
 
-        void closeButtonPressed() override
-        {
-            // This is called when the user tries to close this window. Here, we'll just
-            // ask the app to quit when this happens, but you can change this to do
-            // whatever you need.
-            JUCEApplication::getInstance()->systemRequestedQuit();
-        }
-
-        /* Note: Be careful if you override any DocumentWindow methods - the base
-           class uses a lot of them, so by overriding you might break its functionality.
-           It's best to do all your work in your content component instead, but if
-           you really have to override any DocumentWindow methods, make sure your
-           subclass also calls the superclass's method.
-        */
-
-    private:
-        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MainWindow)
-    };
-
-private:
-    std::unique_ptr<MainWindow> mainWindow;
-};
-
-//==============================================================================
-// This macro generates the main() routine that launches the app.
-START_JUCE_APPLICATION (VoxProcessorApplication)
+    auto numFailed = OfflineRenderer(std::move(settings)).run();
+    return numFailed == 0 ? 0 : 1;
+}
@@ -0,0 +1,225 @@
+/*
+  ==============================================================================
+
+    OfflineRenderer.cpp
+    Created: 16 Oct 2026 1:41:09pm
+    Author:  Morris Sound
+
+  ==============================================================================
+*/
+
+#include "OfflineRenderer.h"
+#include "../VoxProcessor/Source/PluginProcessor.h"
+
+//==============================================================================
+struct OfflineRenderer::Worker : juce::Thread
+{
+    Worker(OfflineRenderer& o, int index) :
+        juce::Thread("VoxRender worker " + juce::String(index)),
+        owner(o)
+    {
+        //the processor is built here, on the message thread, and only used by this worker afterwards.
+        processor = std::make_unique<VoxProcessorAudioProcessor>();
+        formatManager.registerBasicFormats();
+    }
+
+    void run() override
+    {
+        const auto& files = owner.settings.inputFiles;
+
+        while( ! threadShouldExit() )
+        {
+            auto index = owner.nextFileIndex.fetch_add(1);
+            if( index >= files.size() )
+                break;
+
+            const auto& input = files.getReference(index);
+            auto startMs = juce::Time::getMillisecondCounterHiRes();
+            auto result = owner.renderFile(*processor, formatManager, input);
+            auto elapsedSeconds = (juce::Time::getMillisecondCounterHiRes() - startMs) * 0.001;
+
+            if( result.error.isNotEmpty() )
+            {
+                ++owner.numFailed;
+                owner.log("FAILED " + input.getFullPathName() + ": " + result.error);
+                continue;
+            }
+
+            auto audioSeconds = static_cast<double>(result.numSamplesWritten) / result.sampleRate;
+            owner.log(input.getFileName()
+                      + " -> " + result.output.getFullPathName()
+                      + " (" + juce::String(audioSeconds, 2) + "s of audio in "
+                      + juce::String(elapsedSeconds, 2) + "s, "
+                      + juce::String(audioSeconds / juce::jmax(elapsedSeconds, 1.0e-6), 1) + "x realtime, "
+                      + juce::String(result.integratedLufs, 1) + " LUFS, LRA "
+                      + juce::String(result.loudnessRangeLu, 1) + " LU)");
+        }
+    }
+
+    OfflineRenderer& owner;
+    std::unique_ptr<VoxProcessorAudioProcessor> processor;
+    juce::AudioFormatManager formatManager;
+};
+
+//==============================================================================
+OfflineRenderer::OfflineRenderer(Settings s) : settings(std::move(s))
+{
+    settings.blockSize = juce::jmax(1, settings.blockSize);
+    settings.numThreads = juce::jlimit(1, juce::jmax(1, settings.inputFiles.size()), settings.numThreads);
+}
+
+int OfflineRenderer::run()
+{
+    if( ! settings.outputDirectory.createDirectory() )
+    {
+        log("could not create output directory " + settings.outputDirectory.getFullPathName());
+        return settings.inputFiles.size();
+    }
+
+    nextFileIndex = 0;
+    numFailed = 0;
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    for( int i = 0; i < settings.numThreads; ++i )
+        workers.push_back(std::make_unique<Worker>(*this, i));
+
+    for( auto& w : workers )
+        w->startThread();
+
+    for( auto& w : workers )
+        w->waitForThreadToExit(-1);
+
+    return numFailed.load();
+}
+
+juce::Array<juce::File> OfflineRenderer::findAudioFiles(const juce::File& fileOrDirectory)
+{
+    if( fileOrDirectory.existsAsFile() )
+        return { fileOrDirectory };
+
+    juce::AudioFormatManager formatManager;
+    formatManager.registerBasicFormats();
+
+    auto files = fileOrDirectory.findChildFiles(juce::File::findFiles,
+                                                false,
+                                                formatManager.getWildcardForAllFormats());
+    files.sort();
+    return files;
+}
+
+OfflineRenderer::RenderResult OfflineRenderer::renderFile(VoxProcessorAudioProcessor& processor,
+                                                          juce::AudioFormatManager& formatManager,
+                                                          const juce::File& input) const
+{
+    RenderResult result;
+    result.output = settings.outputDirectory.getChildFile(input.getFileName());
+
+    if( result.output == input )
+    {
+        result.error = "the output would overwrite the input file";
+        return result;
+    }
+
+    std::unique_ptr<juce::AudioFormatReader> reader (formatManager.createReaderFor(input));
+    auto* format = formatManager.findFormatForFileExtension(input.getFileExtension());
+    if( reader == nullptr || format == nullptr )
+    {
+        result.error = "unsupported or unreadable audio file";
+        return result;
+    }
+
+    result.sampleRate = reader->sampleRate;
+    const auto numFileChannels = static_cast<int>(reader->numChannels);
+
+    result.output.deleteFile();
+    auto stream = std::make_unique<juce::FileOutputStream>(result.output);
+    if( stream->failedToOpen() )
+    {
+        result.error = "could not open " + result.output.getFullPathName() + " for writing";
+        return result;
+    }
+
+    std::unique_ptr<juce::AudioFormatWriter> writer (format->createWriterFor(stream.get(),
+                                                                             reader->sampleRate,
+                                                                             static_cast<unsigned int>(numFileChannels),
+                                                                             static_cast<int>(reader->bitsPerSample),
+                                                                             reader->metadataValues,
+                                                                             0));
+    if( writer == nullptr )
+    {
+        result.error = "could not create a " + format->getFormatName() + " writer";
+        return result;
+    }
+    stream.release(); //the writer owns it now
+
+    //The bus is set up to match the file, so mono, stereo and surround stems are all rendered in their own layout.
+    const auto numProcessChannels = numFileChannels;
+    const auto blockSize = settings.blockSize;
+
+    juce::AudioProcessor::BusesLayout layout;
+    layout.inputBuses.add(juce::AudioChannelSet::canonicalChannelSet(numFileChannels));
+    layout.outputBuses.add(juce::AudioChannelSet::canonicalChannelSet(numFileChannels));
+    if( ! processor.setBusesLayout(layout) )
+    {
+        result.error = "unsupported channel layout (" + juce::String(numFileChannels) + " channels)";
+        return result;
+    }
+
+    processor.setRateAndBufferSizeDetails(reader->sampleRate, blockSize);
+    processor.setNonRealtime(true);
+    if( settings.state.getSize() > 0 )
+        processor.setStateInformation(settings.state.getData(), static_cast<int>(settings.state.getSize()));
+    processor.prepareToPlay(reader->sampleRate, blockSize);
+    
+    //the loudness report is the only analysis a render needs
+    auto loudnessSubscription = processor.subscribe(VoxProcessorAudioProcessor::AnalysisFeed::Loudness);
+
+    //render the tail after the end of the file, and drop the first 'latency' samples so the output lines up with the input.
+    const auto latency = static_cast<juce::int64>(processor.getLatencySamples());
+    const auto tail = static_cast<juce::int64>(std::ceil(processor.getTailLengthSeconds() * reader->sampleRate));
+    const auto inputLength = reader->lengthInSamples;
+    const auto totalToProcess = inputLength + tail + latency;
+
+    juce::AudioBuffer<float> buffer(numProcessChannels, blockSize);
+    juce::MidiBuffer midi;
+
+    for( juce::int64 position = 0; position < totalToProcess; )
+    {
+        auto numThisTime = static_cast<int>(juce::jmin<juce::int64>(blockSize, totalToProcess - position));
+        buffer.setSize(numProcessChannels, numThisTime, false, false, true);
+        buffer.clear();
+
+        auto numToRead = static_cast<int>(juce::jlimit<juce::int64>(0, numThisTime, inputLength - position));
+        if( numToRead > 0 )
+            reader->read(&buffer, 0, numToRead, position, true, true);
+
+        processor.processBlock(buffer, midi);
+
+        auto numToSkip = static_cast<int>(juce::jlimit<juce::int64>(0, numThisTime, latency - position));
+        if( numThisTime > numToSkip )
+        {
+            if( ! writer->writeFromAudioSampleBuffer(buffer, numToSkip, numThisTime - numToSkip) )
+            {
+                result.error = "write failed";
+                break;
+            }
+            result.numSamplesWritten += numThisTime - numToSkip;
+        }
+
+        position += numThisTime;
+    }
+
+    //the meter published its last snapshot from this thread, so it can be read back right here
+    processor.outputLoudness.pullSnapshot();
+    result.integratedLufs = processor.outputLoudness.getSnapshot().integratedLufs;
+    result.loudnessRangeLu = processor.outputLoudness.getSnapshot().loudnessRangeLu;
+
+    processor.releaseResources();
+    return result;
+}
+
+void OfflineRenderer::log(const juce::String& message)
+{
+    const juce::ScopedLock sl(logLock);
+    std::cout << message << std::endl;
+}
@@ -0,0 +1,64 @@
+/*
+  ==============================================================================
+
+    OfflineRenderer.h
+    Created: 16 Oct 2026 1:41:09pm
+    Author:  Morris Sound
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+class VoxProcessorAudioProcessor;
+
+/*
+ Streams audio files through VoxProcessorAudioProcessor::processBlock() without a host.
+ Every worker thread owns one processor instance and pulls the next file from a shared index,
+ so independent files are rendered in parallel as fast as the CPUs allow.
+ */
+struct OfflineRenderer
+{
+    struct Settings
+    {
+        juce::Array<juce::File> inputFiles;
+        juce::File outputDirectory;
+        juce::MemoryBlock state; //produced by VoxProcessorAudioProcessor::getStateInformation(), may be empty
+        int blockSize = 512;
+        int numThreads = 1;
+    };
+
+    explicit OfflineRenderer(Settings s);
+
+    //Renders every input file, returns the number of files that failed.
+    int run();
+
+    //A single file, or every audio file directly inside a directory.
+    static juce::Array<juce::File> findAudioFiles(const juce::File& fileOrDirectory);
+
+private:
+    struct Worker;
+
+    struct RenderResult
+    {
+        juce::File output;
+        juce::int64 numSamplesWritten = 0;
+        double sampleRate = 0.0;
+        float integratedLufs = 0.f;
+        float loudnessRangeLu = 0.f;
+        juce::String error;
+    };
+
+    RenderResult renderFile(VoxProcessorAudioProcessor& processor,
+                            juce::AudioFormatManager& formatManager,
+                            const juce::File& input) const;
+
+    void log(const juce::String& message);
+
+    Settings settings;
+    std::atomic<int> nextFileIndex { 0 };
+    std::atomic<int> numFailed { 0 };
+    juce::CriticalSection logLock;
+};
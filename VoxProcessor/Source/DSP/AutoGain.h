@@ -0,0 +1,85 @@
+/*
+  ==============================================================================
+
+    AutoGain.h
+    Created: 16 Oct 2026 9:12:40pm
+    Author:  Morris Sound
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+namespace VoxDSP
+{
+/*
+ Output gain compensation: how much gain the chain added or removed, so the output level can be
+ matched to the input level when A/B-ing settings.
+ It doesn't look at the audio itself. It is fed once per block with the mean square levels that the
+ input and output meters already collect, so it costs a few flops per block.
+ Both levels are averaged over the window, and the correction follows their difference,
+ with the attack time when it has to come down and the release time when it goes back up.
+ While the input is below the gate, or hold is on, the correction stays where it is.
+ */
+struct AutoGain
+{
+    void prepare(double newSampleRate)
+    {
+        sampleRate = newSampleRate;
+        reset();
+    }
+
+    void reset() noexcept
+    {
+        inputLevel = 0.0;
+        chainLevel = 0.0;
+        correctionDb = 0.f;
+    }
+
+    void setTimeConstants(float windowMs, float attackMs, float releaseMs) noexcept
+    {
+        windowSeconds = juce::jmax(0.001, windowMs * 0.001);
+        attackSeconds = juce::jmax(0.001, attackMs * 0.001);
+        releaseSeconds = juce::jmax(0.001, releaseMs * 0.001);
+    }
+
+    void setHold(bool shouldHold) noexcept { hold = shouldHold; }
+
+    /*
+     audio thread, once per block.
+     inputMeanSquare is the level going into the chain, outputMeanSquare the level after the output gain,
+     which was appliedGainDb for this block. The output gain is taken back out, so the correction
+     doesn't chase itself.
+     */
+    void process(double inputMeanSquare, double outputMeanSquare, float appliedGainDb, int numSamples) noexcept
+    {
+        const auto n = static_cast<double>(numSamples);
+        const auto appliedGain = juce::Decibels::decibelsToGain(static_cast<double>(appliedGainDb));
+
+        const auto window = 1.0 - std::exp(-n / (windowSeconds * sampleRate));
+        inputLevel += (inputMeanSquare - inputLevel) * window;
+        chainLevel += (outputMeanSquare / (appliedGain * appliedGain) - chainLevel) * window;
+
+        if( hold || inputLevel < gateMeanSquare || chainLevel < gateMeanSquare )
+            return;
+
+        auto target = juce::jlimit(-maxCorrectionDb, maxCorrectionDb, static_cast<float>(10.0 * std::log10(inputLevel / chainLevel)));
+        auto seconds = target < correctionDb ? attackSeconds : releaseSeconds;
+        correctionDb += (target - correctionDb) * static_cast<float>(1.0 - std::exp(-n / (seconds * sampleRate)));
+    }
+
+    float getCorrectionDb() const noexcept { return correctionDb; }
+
+private:
+    static constexpr double gateMeanSquare = 1.0e-6; //-60dBFS
+    static constexpr float maxCorrectionDb = 24.f;
+
+    double sampleRate = 44100.0;
+    double windowSeconds = 0.4, attackSeconds = 0.5, releaseSeconds = 2.0;
+    double inputLevel = 0.0, chainLevel = 0.0;
+    float correctionDb = 0.f;
+    bool hold = false;
+};
+} //end namespace VoxDSP
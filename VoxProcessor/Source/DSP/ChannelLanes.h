@@ -0,0 +1,108 @@
+/*
+  ==============================================================================
+
+    ChannelLanes.h
+    Created: 16 Oct 2026 5:08:31pm
+    Author:  Morris Sound
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+namespace VoxDSP
+{
+/*
+ Runs a per sample kernel over several channels at once, one channel per SIMD lane.
+ The filters keep one register of state per group of channels and share their coefficients
+ across the lanes, so stereo costs the same arithmetic as mono.
+ The channels are transposed tileSize samples at a time into an interleaved, aligned tile:
+ the kernel then loads and stores whole registers, and the copies in and out run along each
+ channel instead of across the channels for every sample.
+ Lanes without a channel are fed silence and never written back.
+ */
+struct ChannelLanes
+{
+    using Register = juce::dsp::SIMDRegister<float>;
+    static constexpr size_t numLanes = Register::SIMDNumElements;
+    static constexpr size_t tileSize = 32;
+
+    static size_t getNumGroups(size_t numChannels) noexcept { return (numChannels + numLanes - 1) / numLanes; }
+
+    /*
+     Calls kernel(Register input) -> Register output for every sample of the range,
+     for the channels firstChannel .. firstChannel + numLanes (or fewer at the end of the block).
+     */
+    template<typename Kernel>
+    static void process(const juce::dsp::AudioBlock<const float>& inputBlock,
+                        juce::dsp::AudioBlock<float>& outputBlock,
+                        size_t firstChannel,
+                        size_t startSample,
+                        size_t numSamples,
+                        Kernel&& kernel) noexcept
+    {
+        const auto numChannels = juce::jmin(numLanes, outputBlock.getNumChannels() - firstChannel);
+
+        //x keeps its silent lanes, y is only read back for the lanes with a channel
+        alignas(Register::SIMDRegisterSize) float x[tileSize * numLanes] {};
+        alignas(Register::SIMDRegisterSize) float y[tileSize * numLanes];
+
+        for( size_t start = 0; start < numSamples; start += tileSize )
+        {
+            const auto n = juce::jmin(tileSize, numSamples - start);
+            gather(inputBlock, firstChannel, numChannels, startSample + start, n, x);
+
+            for( size_t i = 0; i < n; ++i )
+                kernel(Register::fromRawArray(x + i * numLanes)).copyToRawArray(y + i * numLanes);
+
+            for( size_t lane = 0; lane < numChannels; ++lane )
+            {
+                auto* out = outputBlock.getChannelPointer(firstChannel + lane) + startSample + start;
+                for( size_t i = 0; i < n; ++i )
+                    out[i] = y[i * numLanes + lane];
+            }
+        }
+    }
+
+    //Read only version for analysis: calls kernel(Register input) for every sample, nothing is written back.
+    template<typename Kernel>
+    static void read(const juce::dsp::AudioBlock<const float>& inputBlock,
+                     size_t firstChannel,
+                     size_t startSample,
+                     size_t numSamples,
+                     Kernel&& kernel) noexcept
+    {
+        const auto numChannels = juce::jmin(numLanes, inputBlock.getNumChannels() - firstChannel);
+
+        alignas(Register::SIMDRegisterSize) float x[tileSize * numLanes] {};
+
+        for( size_t start = 0; start < numSamples; start += tileSize )
+        {
+            const auto n = juce::jmin(tileSize, numSamples - start);
+            gather(inputBlock, firstChannel, numChannels, startSample + start, n, x);
+
+            for( size_t i = 0; i < n; ++i )
+                kernel(Register::fromRawArray(x + i * numLanes));
+        }
+    }
+
+private:
+    //n samples of numChannels channels into the interleaved tile, lane by lane
+    static void gather(const juce::dsp::AudioBlock<const float>& block,
+                       size_t firstChannel,
+                       size_t numChannels,
+                       size_t startSample,
+                       size_t n,
+                       float* tile) noexcept
+    {
+        for( size_t lane = 0; lane < numChannels; ++lane )
+        {
+            const auto* in = block.getChannelPointer(firstChannel + lane) + startSample;
+            for( size_t i = 0; i < n; ++i )
+                tile[i * numLanes + lane] = in[i];
+        }
+    }
+};
+} //end namespace VoxDSP
@@ -0,0 +1,89 @@
+/*
+  ==============================================================================
+
+    CoefficientRamp.h
+    Created: 16 Oct 2026 11:03:17am
+    Author:  Morris Sound
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+namespace VoxDSP
+{
+/*
+ Linear interpolation of a small set of filter coefficients across one processing block.
+ The owner sets the target values before process(), and the ramp reaches them exactly on the
+ last sample of the block. The coefficients are advanced every 'interval' samples (1 == per sample),
+ so a fast sweep costs one coefficient update per interval instead of one filter redesign per chunk.
+ Only interpolate values that are stable when blended linearly (SVF g/k, one-pole coefficients etc).
+ */
+template<size_t NumValues>
+struct CoefficientRamp
+{
+    using Values = std::array<float, NumValues>;
+
+    void setTarget(const Values& newTarget) noexcept { target = newTarget; }
+    void snapToTarget() noexcept
+    {
+        current = target;
+        stepsRemaining = 0;
+    }
+
+    bool isRamping() const noexcept { return current != target; }
+    const Values& getCurrent() const noexcept { return current; }
+    const Values& getTarget() const noexcept { return target; }
+
+    /*
+     Calls processRange(startSample, numSamplesInRange) for every interval of the block,
+     advancing the current values before each call.
+     When nothing is moving the whole block is handed over in one call.
+     */
+    template<typename ProcessRange>
+    void process(size_t numSamples, int interval, ProcessRange&& processRange)
+    {
+        if( ! isRamping() )
+        {
+            processRange(size_t(0), numSamples);
+            return;
+        }
+
+        const auto stepSize = static_cast<size_t>(juce::jmax(1, interval));
+        const auto numSteps = static_cast<int>((numSamples + stepSize - 1) / stepSize);
+        startRamp(numSteps);
+
+        for( size_t start = 0; start < numSamples; start += stepSize )
+        {
+            step();
+            processRange(start, juce::jmin(stepSize, numSamples - start));
+        }
+    }
+
+private:
+    void startRamp(int numSteps) noexcept
+    {
+        stepsRemaining = juce::jmax(1, numSteps);
+        const auto scale = 1.f / static_cast<float>(stepsRemaining);
+        for( size_t i = 0; i < NumValues; ++i )
+            increment[i] = (target[i] - current[i]) * scale;
+    }
+
+    void step() noexcept
+    {
+        if( --stepsRemaining <= 0 )
+        {
+            current = target;
+            return;
+        }
+
+        for( size_t i = 0; i < NumValues; ++i )
+            current[i] += increment[i];
+    }
+
+    Values current {}, target {}, increment {};
+    int stepsRemaining = 0;
+};
+} //end namespace VoxDSP
@@ -0,0 +1,58 @@
+/*
+  ==============================================================================
+
+    GainRamp.h
+    Created: 16 Oct 2026 9:47:18pm
+    Author:  Morris Sound
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+namespace VoxDSP
+{
+/*
+ Turns a smoother in dB into one linear gain per sample, a chunk at a time.
+ A straight line in dB is a geometric series in gain, so a chunk costs two decibelsToGain() calls,
+ one pow() and a multiply per sample, however fast the smoother moves. When the smoother stops
+ inside a chunk the ramp is spread over the whole chunk, which is inaudible at this size.
+ The gains are shared by every channel, which multiply them in SIMD lanes.
+ */
+struct GainRamp
+{
+    static constexpr size_t chunkSize = 64;
+
+    //Advances the smoother by numSamples (at most chunkSize) and writes the gain for each of those samples.
+    static void next(juce::SmoothedValue<float>& gainDb, float* gains, size_t numSamples) noexcept
+    {
+        jassert(numSamples > 0 && numSamples <= chunkSize);
+
+        const auto start = juce::Decibels::decibelsToGain(gainDb.getCurrentValue());
+        if( ! gainDb.isSmoothing() )
+        {
+            std::fill(gains, gains + numSamples, start);
+            return;
+        }
+
+        gainDb.skip(static_cast<int>(numSamples));
+        const auto end = juce::Decibels::decibelsToGain(gainDb.getCurrentValue());
+        if( start <= 0.f || end <= 0.f )
+        {
+            std::fill(gains, gains + numSamples, end);
+            return;
+        }
+
+        const auto ratio = std::pow(end / start, 1.f / static_cast<float>(numSamples));
+        auto g = start;
+        for( size_t i = 0; i < numSamples; ++i )
+        {
+            g *= ratio;
+            gains[i] = g;
+        }
+        gains[numSamples - 1] = end; //no drift from the rounding in the series
+    }
+};
+} //end namespace VoxDSP
@@ -0,0 +1,220 @@
+/*
+  ==============================================================================
+
+    GeneralFilter.h
+    Created: 16 Oct 2026 10:12:41am
+    Author:  Morris Sound
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "CoefficientRamp.h"
+#include "ChannelLanes.h"
+
+namespace VoxDSP
+{
+enum class GeneralFilterMode
+{
+    Peak,
+    Bandpass,
+    Notch,
+    Allpass,
+    END_OF_LIST
+};
+
+/*
+ Second order filter used by the General Filter stage.
+ It is a trapezoidal (TPT) state variable filter: every mode is a mix of the input and the
+ band output, so the peak, bandpass, notch and allpass responses all come from the same g/k pair.
+ g/k can be interpolated per sample without the stability problems of blending biquad coefficients,
+ which lets the stage run a whole host block and still follow fast automation without zipper noise.
+ The coefficients are computed in place and never allocate, and the filter state is never reset
+ when they change. All channels share one set of coefficients and run side by side in SIMD lanes.
+ */
+struct GeneralFilter
+{
+    enum Coefficient
+    {
+        gCoeff,
+        kCoeff,
+        m0Coeff,
+        m1Coeff,
+        m2Coeff,
+        numCoefficients
+    };
+
+    using Coefficients = std::array<float, numCoefficients>;
+
+    static Coefficients design(GeneralFilterMode mode,
+                               double sampleRate,
+                               float freqHz,
+                               float quality,
+                               float gainDb) noexcept
+    {
+        //keep the frequency away from DC and nyquist, tan() blows up there.
+        auto freq = juce::jlimit(1.0, sampleRate * 0.49, static_cast<double>(freqHz));
+        auto q = juce::jmax(1.0e-3, static_cast<double>(quality));
+
+        auto g = std::tan(juce::MathConstants<double>::pi * freq / sampleRate);
+        auto k = 1.0 / q;
+
+        //output = m0 * input + m1 * band + m2 * low
+        double m0 = 1.0, m1 = 0.0, m2 = 0.0;
+
+        switch (mode)
+        {
+            case GeneralFilterMode::Peak:
+            {
+                auto A = std::pow(10.0, static_cast<double>(gainDb) / 40.0);
+                k = 1.0 / (q * A);
+                m1 = k * (A * A - 1.0);
+                break;
+            }
+            case GeneralFilterMode::Bandpass:
+            {
+                //constant 0 dB peak gain, same response as IIR::Coefficients::makeBandPass()
+                m0 = 0.0;
+                m1 = k;
+                break;
+            }
+            case GeneralFilterMode::Notch:
+            {
+                m1 = -k;
+                break;
+            }
+            case GeneralFilterMode::Allpass:
+            {
+                m1 = -2.0 * k;
+                break;
+            }
+            case GeneralFilterMode::END_OF_LIST:
+            {
+                jassertfalse;
+                break;
+            }
+        }
+
+        return
+        {
+            static_cast<float>(g),
+            static_cast<float>(k),
+            static_cast<float>(m0),
+            static_cast<float>(m1),
+            static_cast<float>(m2),
+        };
+    }
+
+    void prepare(const juce::dsp::ProcessSpec& spec)
+    {
+        sampleRate = spec.sampleRate;
+        numChannels = spec.numChannels;
+        state.resize(ChannelLanes::getNumGroups(numChannels));
+        reset();
+    }
+
+    void reset() noexcept
+    {
+        for( auto& s : state )
+            s.fill(Register::expand(0.f));
+
+        snapOnNextBlock = true;
+    }
+
+    /*
+     Sets the coefficients reached at the end of the next processed block.
+     The filter state is left alone so parameter sweeps don't click.
+     */
+    void setParameters(GeneralFilterMode mode, float freqHz, float quality, float gainDb) noexcept
+    {
+        ramp.setTarget(design(mode, sampleRate, freqHz, quality, gainDb));
+    }
+
+    //Same as setParameters(), with coefficients from design() at this filter's sample rate.
+    void setCoefficients(const Coefficients& coefficients) noexcept { ramp.setTarget(coefficients); }
+
+    /*
+     How often the coefficients are advanced while ramping, in samples. 1 == every sample.
+     */
+    void setRampInterval(int numSamples) noexcept { rampInterval = juce::jmax(1, numSamples); }
+
+    const Coefficients& getCoefficients() const noexcept { return ramp.getCurrent(); }
+
+    void process(const juce::dsp::ProcessContextReplacing<float>& context) noexcept
+    {
+        const auto& inputBlock = context.getInputBlock();
+        auto& outputBlock = context.getOutputBlock();
+
+        if( context.isBypassed )
+        {
+            if( context.usesSeparateInputAndOutputBlocks() )
+                outputBlock.copyFrom(inputBlock);
+
+            return;
+        }
+
+        if( snapOnNextBlock )
+        {
+            ramp.snapToTarget();
+            snapOnNextBlock = false;
+        }
+
+        jassert(inputBlock.getNumChannels() == outputBlock.getNumChannels());
+
+        ramp.process(outputBlock.getNumSamples(), rampInterval, [&](size_t start, size_t num)
+        {
+            processRange(inputBlock, outputBlock, start, num);
+        });
+    }
+
+private:
+    void processRange(const juce::dsp::AudioBlock<const float>& inputBlock,
+                      juce::dsp::AudioBlock<float>& outputBlock,
+                      size_t startSample,
+                      size_t numSamples) noexcept
+    {
+        const auto& c = ramp.getCurrent();
+        const auto g = c[gCoeff];
+        const auto k = c[kCoeff];
+        const auto m0 = c[m0Coeff];
+        const auto m1 = c[m1Coeff];
+        const auto m2 = c[m2Coeff];
+
+        const auto a1 = 1.f / (1.f + g * (g + k));
+        const auto a2 = g * a1;
+        const auto a3 = g * a2;
+
+        const auto channelsToProcess = juce::jmin(outputBlock.getNumChannels(), numChannels);
+        for( size_t group = 0; group * ChannelLanes::numLanes < channelsToProcess; ++group )
+        {
+            auto ic1eq = state[group][0];
+            auto ic2eq = state[group][1];
+
+            ChannelLanes::process(inputBlock, outputBlock, group * ChannelLanes::numLanes, startSample, numSamples,
+                                  [&](Register v0)
+            {
+                auto v3 = v0 - ic2eq;
+                auto v1 = ic1eq * a1 + v3 * a2;
+                auto v2 = ic2eq + ic1eq * a2 + v3 * a3;
+                ic1eq = v1 * 2.f - ic1eq;
+                ic2eq = v2 * 2.f - ic2eq;
+
+                return v0 * m0 + v1 * m1 + v2 * m2;
+            });
+
+            state[group] = {{ ic1eq, ic2eq }};
+        }
+    }
+
+    using Register = ChannelLanes::Register;
+
+    CoefficientRamp<numCoefficients> ramp;
+    std::vector<std::array<Register, 2>> state; //one register per group of channels
+    size_t numChannels = 0;
+    double sampleRate = 44100.0;
+    int rampInterval = 1;
+    bool snapOnNextBlock = true;
+};
+} //end namespace VoxDSP
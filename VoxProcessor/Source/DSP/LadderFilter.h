@@ -0,0 +1,205 @@
+/*
+  ==============================================================================
+
+    LadderFilter.h
+    Created: 16 Oct 2026 11:24:52am
+    Author:  Morris Sound
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "CoefficientRamp.h"
+#include "ChannelLanes.h"
+
+namespace VoxDSP
+{
+/*
+ Same four pole ladder model as juce::dsp::LadderFilter, but the cutoff, resonance and drive
+ are driven by a CoefficientRamp instead of the internal 50ms smoothers.
+ The cutoff is interpolated as the one-pole feedback coefficient exp(-2pi * fc / fs), which stays
+ inside (0, 1) for any blend of two valid cutoffs, so the stage can follow automation at full block
+ length without being split into sub-blocks.
+ The channels run side by side in SIMD lanes. Only the tanh lookup is done lane by lane.
+ */
+struct LadderFilter
+{
+    using Mode = juce::dsp::LadderFilterMode;
+
+    void prepare(const juce::dsp::ProcessSpec& spec)
+    {
+        cutoffFreqScaler = -juce::MathConstants<float>::twoPi / static_cast<float>(spec.sampleRate);
+        numChannels = spec.numChannels;
+        state.resize(ChannelLanes::getNumGroups(numChannels));
+
+        setMode(mode);
+        setCutoffFrequencyHz(cutoffFreqHz);
+        reset();
+    }
+
+    void reset() noexcept
+    {
+        for( auto& s : state )
+            s.fill(Register::expand(0.f));
+
+        snapOnNextBlock = true;
+    }
+
+    void setMode(Mode newMode) noexcept
+    {
+        mode = newMode;
+        switch (mode)
+        {
+            case Mode::LPF12: A = {{ 0.f, 0.f,  1.f, 0.f, 0.f }}; comp = 0.5f; break;
+            case Mode::HPF12: A = {{ 1.f, -2.f, 1.f, 0.f, 0.f }}; comp = 0.f;  break;
+            case Mode::BPF12: A = {{ 0.f, 0.f, -1.f, 1.f, 0.f }}; comp = 0.5f; break;
+            case Mode::LPF24: A = {{ 0.f, 0.f,  0.f, 0.f, 1.f }}; comp = 0.5f; break;
+            case Mode::HPF24: A = {{ 1.f, -4.f, 6.f, -4.f, 1.f }}; comp = 0.f; break;
+            case Mode::BPF24: A = {{ 0.f, 0.f,  1.f, -2.f, 1.f }}; comp = 0.5f; break;
+            default: jassertfalse; break;
+        }
+
+        for( auto& a : A )
+            a *= 1.2f;
+    }
+
+    void setCutoffFrequencyHz(float newCutoff) noexcept
+    {
+        jassert(newCutoff > 0.f);
+        cutoffFreqHz = newCutoff;
+        target[cutoffTransform] = std::exp(cutoffFreqHz * cutoffFreqScaler);
+        ramp.setTarget(target);
+    }
+
+    //0 - 1
+    void setResonance(float newResonance) noexcept
+    {
+        jassert(newResonance >= 0.f && newResonance <= 1.f);
+        target[scaledResonance] = juce::jmap(newResonance, 0.1f, 1.f);
+        ramp.setTarget(target);
+    }
+
+    //>= 1
+    void setDrive(float newDrive) noexcept
+    {
+        jassert(newDrive >= 1.f);
+        auto drive2 = newDrive * 0.04f + 0.96f;
+        target[drive] = newDrive;
+        target[gain] = std::pow(newDrive, -2.642f) * 0.6103f + 0.3903f;
+        target[secondDrive] = drive2;
+        target[secondGain] = std::pow(drive2, -2.642f) * 0.6103f + 0.3903f;
+        ramp.setTarget(target);
+    }
+
+    /*
+     How often the coefficients are advanced while ramping, in samples. 1 == every sample.
+     */
+    void setRampInterval(int numSamples) noexcept { rampInterval = juce::jmax(1, numSamples); }
+
+    void process(const juce::dsp::ProcessContextReplacing<float>& context) noexcept
+    {
+        const auto& inputBlock = context.getInputBlock();
+        auto& outputBlock = context.getOutputBlock();
+
+        if( context.isBypassed )
+        {
+            if( context.usesSeparateInputAndOutputBlocks() )
+                outputBlock.copyFrom(inputBlock);
+
+            return;
+        }
+
+        if( snapOnNextBlock )
+        {
+            ramp.snapToTarget();
+            snapOnNextBlock = false;
+        }
+
+        jassert(inputBlock.getNumChannels() == outputBlock.getNumChannels());
+
+        ramp.process(outputBlock.getNumSamples(), rampInterval, [&](size_t start, size_t num)
+        {
+            processRange(inputBlock, outputBlock, start, num);
+        });
+    }
+
+private:
+    enum RampValue
+    {
+        cutoffTransform,
+        scaledResonance,
+        drive,
+        gain,
+        secondDrive,
+        secondGain,
+        numRampValues
+    };
+
+    void processRange(const juce::dsp::AudioBlock<const float>& inputBlock,
+                      juce::dsp::AudioBlock<float>& outputBlock,
+                      size_t startSample,
+                      size_t numSamples) noexcept
+    {
+        const auto& v = ramp.getCurrent();
+        const auto a1 = v[cutoffTransform];
+        const auto g = 1.f - a1;
+        const auto b0 = g * 0.76923076923f;
+        const auto b1 = g * 0.23076923076f;
+        const auto resonance = v[scaledResonance] * -4.f;
+        const auto drv = v[drive];
+        const auto gn = v[gain];
+        const auto drv2 = v[secondDrive];
+        const auto gn2 = v[secondGain];
+
+        auto saturate = [this](Register x)
+        {
+            for( size_t lane = 0; lane < ChannelLanes::numLanes; ++lane )
+                x.set(lane, saturationLUT(x.get(lane)));
+            return x;
+        };
+
+        const auto channelsToProcess = juce::jmin(outputBlock.getNumChannels(), numChannels);
+        for( size_t group = 0; group * ChannelLanes::numLanes < channelsToProcess; ++group )
+        {
+            auto s = state[group];
+
+            ChannelLanes::process(inputBlock, outputBlock, group * ChannelLanes::numLanes, startSample, numSamples,
+                                  [&](Register x)
+            {
+                const auto dx = saturate(x * drv) * gn;
+                const auto a = dx + (saturate(s[4] * drv2) * gn2 - dx * comp) * resonance;
+
+                const auto b = s[0] * b1 + s[1] * a1 + a * b0;
+                const auto c = s[1] * b1 + s[2] * a1 + b * b0;
+                const auto d = s[2] * b1 + s[3] * a1 + c * b0;
+                const auto e = s[3] * b1 + s[4] * a1 + d * b0;
+
+                s = {{ a, b, c, d, e }};
+
+                return a * A[0] + b * A[1] + c * A[2] + d * A[3] + e * A[4];
+            });
+
+            state[group] = s;
+        }
+    }
+
+    using Register = ChannelLanes::Register;
+
+    CoefficientRamp<numRampValues> ramp;
+    CoefficientRamp<numRampValues>::Values target {{ 1.f, 0.1f, 1.f, 1.f, 1.f, 1.f }};
+
+    juce::dsp::LookupTableTransform<float> saturationLUT { [](float x) { return std::tanh(x); }, -5.f, 5.f, 128 };
+
+    std::vector<std::array<Register, 5>> state; //one register per group of channels
+    size_t numChannels = 0;
+    std::array<float, 5> A {};
+    float comp = 0.5f;
+    float cutoffFreqHz = 200.f;
+    float cutoffFreqScaler = -juce::MathConstants<float>::twoPi / 44100.f;
+    Mode mode = Mode::LPF12;
+    int rampInterval = 1;
+    bool snapOnNextBlock = true;
+};
+} //end namespace VoxDSP
@@ -0,0 +1,323 @@
+/*
+  ==============================================================================
+
+    LevelMeter.h
+    Created: 16 Oct 2026 7:48:20pm
+    Author:  Morris Sound
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "ChannelLanes.h"
+#include "GainRamp.h"
+#include "TripleBuffer.h"
+
+namespace VoxDSP
+{
+/*
+ RMS, sample peak, true peak and true peak hold for every channel, in one pass over the block.
+ The channels run side by side in SIMD lanes like the filters.
+ Everything integrates per sample (RMS over a 300ms time constant, peaks with a 12dB/s release),
+ so the readings don't depend on the host block size.
+ True peak is the 4x polyphase interpolator from ITU-R BS.1770-4 annex 2.
+ The readings are handed to the GUI through a TripleBuffer, one snapshot per block.
+ The mean square and peak of the last block are kept for the audio thread too, for the auto gain
+ and the silence detection.
+ The gain stages meter through processWithGain(), so their buffer is only walked once.
+ While nobody looks at the readings they can be switched off: the block mean square and peak are
+ still collected, the RMS, peaks and true peak stand still and nothing is published.
+ */
+struct LevelMeter
+{
+    using Register = ChannelLanes::Register;
+    static constexpr size_t numLanes = ChannelLanes::numLanes;
+    static constexpr size_t maxChannels = 16; //7.1.4 plus room, channels above this aren't metered
+
+    struct Reading
+    {
+        float rms = 0.f;
+        float peak = 0.f;
+        float truePeak = 0.f;
+        float truePeakHold = 0.f;
+    };
+
+    struct Snapshot
+    {
+        std::array<Reading, maxChannels> channels {};
+        size_t numChannels = 0;
+    };
+
+    void prepare(double sampleRate, int numChannels)
+    {
+        numMeteredChannels = juce::jmin(maxChannels, static_cast<size_t>(juce::jmax(0, numChannels)));
+        groups.resize(ChannelLanes::getNumGroups(numMeteredChannels));
+
+        rmsCoefficient = static_cast<float>(1.0 - std::exp(-1.0 / (rmsTimeConstantSeconds * sampleRate)));
+        releaseCoefficient = static_cast<float>(std::pow(10.0, -releaseDbPerSecond / (20.0 * sampleRate)));
+        holdSamples = static_cast<int>(holdSeconds * sampleRate);
+        reset();
+    }
+
+    void reset() noexcept
+    {
+        for( auto& g : groups )
+        {
+            g.meanSquare = Register::expand(0.f);
+            g.blockEnergy = Register::expand(0.f);
+            g.peak = Register::expand(0.f);
+            g.truePeak = Register::expand(0.f);
+            g.history.fill(Register::expand(0.f));
+            g.writePos = 0;
+        }
+
+        holdCounters.fill(0);
+        blockMeanSquare = 0.0;
+        blockPeak = 0.f;
+        snapshot = {};
+        snapshot.numChannels = numMeteredChannels;
+        snapshots.write(snapshot);
+    }
+
+    /*
+     audio thread. Switching the readings back on starts them from silence, so they don't show
+     whatever was left in them when they were switched off.
+     */
+    void setReadingsEnabled(bool shouldUpdateReadings) noexcept
+    {
+        if( shouldUpdateReadings && ! readingsEnabled )
+            reset();
+
+        readingsEnabled = shouldUpdateReadings;
+    }
+
+    //audio thread
+    void process(const juce::dsp::AudioBlock<const float>& block) noexcept
+    {
+        if( readingsEnabled )
+            meter<true>(block);
+        else
+            meter<false>(block);
+    }
+
+    /*
+     audio thread. Applies the gain from the dB smoother to the block, one value per sample,
+     and meters the result in the same pass. Channels past maxChannels get the gain but aren't metered.
+     */
+    void processWithGain(juce::dsp::AudioBlock<float> block, juce::SmoothedValue<float>& gainDb) noexcept
+    {
+        if( readingsEnabled )
+            meterWithGain<true>(block, gainDb);
+        else
+            meterWithGain<false>(block, gainDb);
+    }
+
+    //GUI thread. Picks up the latest snapshot, returns true when there was a new one.
+    bool pullSnapshot() noexcept { return snapshots.update(); }
+
+    //GUI thread. The snapshot picked up by the last pullSnapshot().
+    const Snapshot& getSnapshot() const noexcept { return snapshots.read(); }
+
+    //audio thread. Mean square over every metered channel of the last processed block.
+    double getBlockMeanSquare() const noexcept { return blockMeanSquare; }
+
+    //audio thread. Largest magnitude over every metered channel of the last processed block.
+    float getBlockPeak() const noexcept { return blockPeak; }
+
+private:
+    static constexpr double rmsTimeConstantSeconds = 0.3;
+    static constexpr double releaseDbPerSecond = 12.0;
+    static constexpr double holdSeconds = 1.5;
+    static constexpr size_t numTaps = 12;
+
+    template<bool UpdateReadings>
+    void meter(const juce::dsp::AudioBlock<const float>& block) noexcept
+    {
+        const auto numChannels = juce::jmin(numMeteredChannels, block.getNumChannels());
+        beginBlock(numChannels);
+
+        for( size_t g = 0; g * numLanes < numChannels; ++g )
+        {
+            auto& s = groups[g];
+            ChannelLanes::read(block, g * numLanes, 0, block.getNumSamples(), [&](Register x) { meterSample<UpdateReadings>(s, x); });
+        }
+
+        endBlock<UpdateReadings>(numChannels, block.getNumSamples());
+    }
+
+    template<bool UpdateReadings>
+    void meterWithGain(juce::dsp::AudioBlock<float> block, juce::SmoothedValue<float>& gainDb) noexcept
+    {
+        const auto numChannels = juce::jmin(numMeteredChannels, block.getNumChannels());
+        const auto numSamples = block.getNumSamples();
+        beginBlock(numChannels);
+
+        //the channels past the metered groups only need the gain
+        const auto numGroups = ChannelLanes::getNumGroups(numChannels);
+        const auto firstUnmeteredChannel = juce::jmin(block.getNumChannels(), numGroups * numLanes);
+
+        alignas(Register::SIMDRegisterSize) float gains[GainRamp::chunkSize];
+        for( size_t start = 0; start < numSamples; start += GainRamp::chunkSize )
+        {
+            const auto n = juce::jmin(GainRamp::chunkSize, numSamples - start);
+            GainRamp::next(gainDb, gains, n);
+
+            for( size_t g = 0; g < numGroups; ++g )
+            {
+                size_t i = 0;
+                auto& s = groups[g];
+                ChannelLanes::process(block, block, g * numLanes, start, n, [&](Register x)
+                {
+                    auto y = x * gains[i++];
+                    meterSample<UpdateReadings>(s, y);
+                    return y;
+                });
+            }
+
+            for( auto ch = firstUnmeteredChannel; ch < block.getNumChannels(); ++ch )
+                juce::FloatVectorOperations::multiply(block.getChannelPointer(ch) + start, gains, static_cast<int>(n));
+        }
+
+        endBlock<UpdateReadings>(numChannels, numSamples);
+    }
+
+    //ITU-R BS.1770-4 annex 2, 48 taps split into the four phases
+    static constexpr std::array<std::array<float, numTaps>, 4> truePeakPhases
+    {{
+        {{  0.0017089843750f,  0.0109863281250f, -0.0196533203125f,  0.0332031250000f, -0.0594482421875f,  0.1373291015625f,
+            0.9721679687500f, -0.1022949218750f,  0.0476074218750f, -0.0266113281250f,  0.0148925781250f, -0.0083007812500f }},
+        {{ -0.0291748046875f,  0.0292968750000f, -0.0517578125000f,  0.0891113281250f, -0.1665039062500f,  0.4650878906250f,
+            0.7797851562500f, -0.2003173828125f,  0.1015625000000f, -0.0582275390625f,  0.0330810546875f, -0.0189208984375f }},
+        {{ -0.0189208984375f,  0.0330810546875f, -0.0582275390625f,  0.1015625000000f, -0.2003173828125f,  0.7797851562500f,
+            0.4650878906250f, -0.1665039062500f,  0.0891113281250f, -0.0517578125000f,  0.0292968750000f, -0.0291748046875f }},
+        {{ -0.0083007812500f,  0.0148925781250f, -0.0266113281250f,  0.0476074218750f, -0.1022949218750f,  0.9721679687500f,
+            0.1373291015625f, -0.0594482421875f,  0.0332031250000f, -0.0196533203125f,  0.0109863281250f,  0.0017089843750f }},
+    }};
+
+    struct GroupState
+    {
+        Register meanSquare, blockEnergy, blockPeak, peak, truePeak;
+        std::array<Register, numTaps * 2> history;
+        size_t writePos = 0;
+    };
+
+    void beginBlock(size_t numChannels) noexcept
+    {
+        for( size_t g = 0; g * numLanes < numChannels; ++g )
+        {
+            groups[g].blockEnergy = Register::expand(0.f);
+            groups[g].blockPeak = Register::expand(0.f);
+        }
+    }
+
+    template<bool UpdateReadings>
+    void meterSample(GroupState& s, Register x) noexcept
+    {
+        const auto zero = Register::expand(0.f);
+
+        auto x2 = x * x;
+        s.blockEnergy += x2;
+
+        auto absX = Register::max(x, zero - x);
+        s.blockPeak = Register::max(s.blockPeak, absX);
+
+        if constexpr( UpdateReadings )
+            updateReadings(s, x, x2, absX);
+    }
+
+    void updateReadings(GroupState& s, Register x, Register x2, Register absX) noexcept
+    {
+        const auto zero = Register::expand(0.f);
+
+        s.meanSquare += (x2 - s.meanSquare) * rmsCoefficient;
+        s.peak = Register::max(absX, s.peak * releaseCoefficient);
+
+        //the history is written twice, so the last numTaps samples are always contiguous, oldest first
+        s.history[s.writePos] = x;
+        s.history[s.writePos + numTaps] = x;
+        s.writePos = s.writePos + 1 == numTaps ? 0 : s.writePos + 1;
+        const auto* window = s.history.data() + s.writePos;
+
+        auto truePeak = Register::max(absX, s.truePeak * releaseCoefficient);
+        for( const auto& phase : truePeakPhases )
+        {
+            auto y = zero;
+            for( size_t k = 0; k < numTaps; ++k )
+                y += window[numTaps - 1 - k] * phase[k];
+
+            truePeak = Register::max(truePeak, Register::max(y, zero - y));
+        }
+        s.truePeak = truePeak;
+    }
+
+    template<bool UpdateReadings>
+    void endBlock(size_t numChannels, size_t numSamples) noexcept
+    {
+        double energy = 0.0;
+        alignas(Register::SIMDRegisterSize) float peaks[numLanes];
+        blockPeak = 0.f;
+        for( size_t g = 0; g * numLanes < numChannels; ++g )
+        {
+            energy += static_cast<double>(groups[g].blockEnergy.sum());
+            groups[g].blockPeak.copyToRawArray(peaks);
+            blockPeak = juce::jmax(blockPeak, *std::max_element(peaks, peaks + numLanes));
+        }
+
+        const auto numValues = numChannels * numSamples;
+        blockMeanSquare = numValues > 0 ? energy / static_cast<double>(numValues) : 0.0;
+        if constexpr( UpdateReadings )
+            publish(numChannels, static_cast<int>(numSamples));
+    }
+
+    void publish(size_t numChannels, int numSamples) noexcept
+    {
+        alignas(Register::SIMDRegisterSize) float meanSquare[numLanes];
+        alignas(Register::SIMDRegisterSize) float peak[numLanes];
+        alignas(Register::SIMDRegisterSize) float truePeak[numLanes];
+
+        snapshot.numChannels = numChannels;
+        for( size_t g = 0; g * numLanes < numChannels; ++g )
+        {
+            groups[g].meanSquare.copyToRawArray(meanSquare);
+            groups[g].peak.copyToRawArray(peak);
+            groups[g].truePeak.copyToRawArray(truePeak);
+
+            for( size_t lane = 0; lane < numLanes && g * numLanes + lane < numChannels; ++lane )
+            {
+                const auto ch = g * numLanes + lane;
+                auto& r = snapshot.channels[ch];
+                r.rms = std::sqrt(meanSquare[lane]);
+                r.peak = peak[lane];
+                r.truePeak = truePeak[lane];
+
+                if( r.truePeak >= r.truePeakHold || holdCounters[ch] >= holdSamples )
+                {
+                    r.truePeakHold = r.truePeak;
+                    holdCounters[ch] = 0;
+                }
+                else
+                {
+                    holdCounters[ch] += numSamples;
+                }
+            }
+        }
+
+        snapshots.write(snapshot);
+    }
+
+    std::vector<GroupState> groups;
+    size_t numMeteredChannels = 0;
+
+    float rmsCoefficient = 1.f, releaseCoefficient = 0.f;
+    int holdSamples = 0;
+    std::array<int, maxChannels> holdCounters {};
+    double blockMeanSquare = 0.0;
+    float blockPeak = 0.f;
+    bool readingsEnabled = true;
+
+    Snapshot snapshot; //audio thread working copy
+    TripleBuffer<Snapshot> snapshots;
+};
+} //end namespace VoxDSP
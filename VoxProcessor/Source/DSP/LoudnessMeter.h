@@ -0,0 +1,340 @@
+/*
+  ==============================================================================
+
+    LoudnessMeter.h
+    Created: 16 Oct 2026 8:31:05pm
+    Author:  Morris Sound
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "ChannelLanes.h"
+#include "TripleBuffer.h"
+
+namespace VoxDSP
+{
+/*
+ ITU-R BS.1770-4 / EBU R128 loudness: momentary (400ms), short-term (3s), integrated and loudness range.
+ The K-weighting filters run the channels side by side in SIMD lanes. The weighted energy is collected
+ in 100ms steps, counted in samples, so the host block size doesn't matter.
+ The last 30 steps live in a ring, which gives the momentary and short-term windows.
+ Integrated loudness and LRA need every gating block since the start. Instead of keeping the blocks, they
+ are counted into fixed histograms of 0.1 LU bins, so nothing grows while playing. The gates are
+ resolved to 0.1 LU, the energy in each bin is kept exactly.
+ A snapshot is published through a TripleBuffer at the end of every step.
+ */
+struct LoudnessMeter
+{
+    using Register = ChannelLanes::Register;
+    static constexpr size_t numLanes = ChannelLanes::numLanes;
+    static constexpr float silence = -std::numeric_limits<float>::infinity();
+
+    struct Snapshot
+    {
+        float momentaryLufs = silence;
+        float shortTermLufs = silence;
+        float integratedLufs = silence;
+        float loudnessRangeLu = 0.f;
+    };
+
+    void prepare(double sampleRate, const juce::AudioChannelSet& layout)
+    {
+        numChannels = static_cast<size_t>(layout.size());
+        groups.resize(ChannelLanes::getNumGroups(numChannels));
+
+        //channel weights from BS.1770-4 table 3: surrounds count 1.41, the LFE isn't measured
+        for( size_t g = 0; g < groups.size(); ++g )
+        {
+            alignas(Register::SIMDRegisterSize) float w[numLanes] {};
+            for( size_t lane = 0; lane < numLanes && g * numLanes + lane < numChannels; ++lane )
+                w[lane] = getChannelWeight(layout.getTypeOfChannel(static_cast<int>(g * numLanes + lane)));
+
+            groups[g].weights = Register::fromRawArray(w);
+        }
+
+        designKWeighting(sampleRate);
+        samplesPerStep = juce::jmax(1, juce::roundToInt(sampleRate * 0.1));
+        reset();
+    }
+
+    void reset() noexcept
+    {
+        for( auto& g : groups )
+        {
+            g.shelf.fill(Register::expand(0.f));
+            g.highpass.fill(Register::expand(0.f));
+            g.energy = Register::expand(0.f);
+        }
+
+        stepEnergy.fill(0.0);
+        stepIndex = 0;
+        numSteps = 0;
+        stepPosition = 0;
+
+        integratedEnergy.fill(0.0);
+        integratedCounts.fill(0);
+        integratedTotalEnergy = 0.0;
+        integratedTotalCount = 0;
+
+        shortTermCounts.fill(0);
+        shortTermTotalEnergy = 0.0;
+        shortTermTotalCount = 0;
+
+        snapshot = {};
+        snapshots.write(snapshot);
+    }
+
+    //audio thread
+    void process(const juce::dsp::AudioBlock<const float>& block) noexcept
+    {
+        const auto numSamples = block.getNumSamples();
+        const auto numBlockChannels = juce::jmin(numChannels, block.getNumChannels());
+
+        for( size_t start = 0; start < numSamples; )
+        {
+            const auto n = juce::jmin(numSamples - start, static_cast<size_t>(samplesPerStep - stepPosition));
+
+            for( size_t g = 0; g * numLanes < numBlockChannels; ++g )
+            {
+                auto& s = groups[g];
+                ChannelLanes::read(block, g * numLanes, start, n, [&](Register x)
+                {
+                    //transposed direct form II, shelf then highpass
+                    auto y = x * shelf.b0 + s.shelf[0];
+                    s.shelf[0] = x * shelf.b1 - y * shelf.a1 + s.shelf[1];
+                    s.shelf[1] = x * shelf.b2 - y * shelf.a2;
+
+                    auto z = y * highpass.b0 + s.highpass[0];
+                    s.highpass[0] = y * highpass.b1 - z * highpass.a1 + s.highpass[1];
+                    s.highpass[1] = y * highpass.b2 - z * highpass.a2;
+
+                    s.energy += z * z;
+                });
+            }
+
+            start += n;
+            stepPosition += static_cast<int>(n);
+            if( stepPosition == samplesPerStep )
+                finishStep();
+        }
+    }
+
+    //reader thread. Picks up the latest snapshot, returns true when there was a new one.
+    bool pullSnapshot() noexcept { return snapshots.update(); }
+
+    //reader thread. The snapshot picked up by the last pullSnapshot().
+    const Snapshot& getSnapshot() const noexcept { return snapshots.read(); }
+
+private:
+    static constexpr size_t momentarySteps = 4;   //400ms
+    static constexpr size_t shortTermSteps = 30;  //3s
+    static constexpr float absoluteGateLufs = -70.f;
+    static constexpr float binsPerLu = 10.f;
+    static constexpr size_t numBins = 800;        //-70 to +10 LUFS
+
+    struct Biquad
+    {
+        float b0 = 1.f, b1 = 0.f, b2 = 0.f, a1 = 0.f, a2 = 0.f;
+    };
+
+    struct GroupState
+    {
+        Register weights;
+        std::array<Register, 2> shelf, highpass;
+        Register energy;
+    };
+
+    static float getChannelWeight(juce::AudioChannelSet::ChannelType type) noexcept
+    {
+        switch (type)
+        {
+            case juce::AudioChannelSet::LFE:
+            case juce::AudioChannelSet::LFE2:
+                return 0.f;
+            case juce::AudioChannelSet::leftSurround:
+            case juce::AudioChannelSet::rightSurround:
+            case juce::AudioChannelSet::leftSurroundSide:
+            case juce::AudioChannelSet::rightSurroundSide:
+                return 1.41f;
+            default:
+                break;
+        }
+        return 1.f;
+    }
+
+    //the two K-weighting stages from BS.1770, redesigned for the sample rate
+    void designKWeighting(double sampleRate) noexcept
+    {
+        {
+            const auto f0 = 1681.974450955533;
+            const auto gainDb = 3.999843853973347;
+            const auto q = 0.7071752369554196;
+
+            const auto k = std::tan(juce::MathConstants<double>::pi * f0 / sampleRate);
+            const auto vh = std::pow(10.0, gainDb / 20.0);
+            const auto vb = std::pow(vh, 0.4996667741545416);
+            const auto a0 = 1.0 + k / q + k * k;
+
+            shelf.b0 = static_cast<float>((vh + vb * k / q + k * k) / a0);
+            shelf.b1 = static_cast<float>(2.0 * (k * k - vh) / a0);
+            shelf.b2 = static_cast<float>((vh - vb * k / q + k * k) / a0);
+            shelf.a1 = static_cast<float>(2.0 * (k * k - 1.0) / a0);
+            shelf.a2 = static_cast<float>((1.0 - k / q + k * k) / a0);
+        }
+        {
+            const auto f0 = 38.13547087602444;
+            const auto q = 0.5003270373238773;
+
+            const auto k = std::tan(juce::MathConstants<double>::pi * f0 / sampleRate);
+            const auto a0 = 1.0 + k / q + k * k;
+
+            highpass.b0 = 1.f;
+            highpass.b1 = -2.f;
+            highpass.b2 = 1.f;
+            highpass.a1 = static_cast<float>(2.0 * (k * k - 1.0) / a0);
+            highpass.a2 = static_cast<float>((1.0 - k / q + k * k) / a0);
+        }
+    }
+
+    static float toLufs(double meanSquare) noexcept
+    {
+        return meanSquare > 0.0 ? static_cast<float>(-0.691 + 10.0 * std::log10(meanSquare)) : silence;
+    }
+
+    static size_t getBin(float lufs) noexcept
+    {
+        auto bin = static_cast<int>((lufs - absoluteGateLufs) * binsPerLu);
+        return static_cast<size_t>(juce::jlimit(0, static_cast<int>(numBins) - 1, bin));
+    }
+
+    static float getBinLufs(size_t bin) noexcept
+    {
+        return absoluteGateLufs + (static_cast<float>(bin) + 0.5f) / binsPerLu;
+    }
+
+    void finishStep() noexcept
+    {
+        double energy = 0.0;
+        for( auto& g : groups )
+        {
+            energy += static_cast<double>((g.energy * g.weights).sum());
+            g.energy = Register::expand(0.f);
+        }
+
+        stepEnergy[stepIndex] = energy / static_cast<double>(samplesPerStep);
+        stepIndex = (stepIndex + 1) % shortTermSteps;
+        numSteps = juce::jmin(numSteps + 1, shortTermSteps);
+        stepPosition = 0;
+
+        auto windowEnergy = [this](size_t numWindowSteps)
+        {
+            double sum = 0.0;
+            for( size_t i = 1; i <= numWindowSteps; ++i )
+                sum += stepEnergy[(stepIndex + shortTermSteps - i) % shortTermSteps];
+            return sum / static_cast<double>(numWindowSteps);
+        };
+
+        const auto momentaryEnergy = windowEnergy(momentarySteps);
+        const auto shortTermEnergy = windowEnergy(shortTermSteps);
+        snapshot.momentaryLufs = toLufs(momentaryEnergy);
+        snapshot.shortTermLufs = toLufs(shortTermEnergy);
+
+        //gating blocks are 400ms with 75% overlap, one per step once the first window is full
+        if( numSteps >= momentarySteps )
+            addGatingBlock(momentaryEnergy, snapshot.momentaryLufs);
+
+        //LRA uses the short-term loudness at the same 10Hz rate
+        if( numSteps >= shortTermSteps )
+            addShortTermValue(shortTermEnergy, snapshot.shortTermLufs);
+
+        snapshots.write(snapshot);
+    }
+
+    void addGatingBlock(double energy, float lufs) noexcept
+    {
+        if( lufs < absoluteGateLufs )
+            return;
+
+        const auto bin = getBin(lufs);
+        integratedEnergy[bin] += energy;
+        ++integratedCounts[bin];
+        integratedTotalEnergy += energy;
+        ++integratedTotalCount;
+
+        //relative gate: 10 LU below the loudness of everything above the absolute gate
+        const auto gateBin = getBin(toLufs(integratedTotalEnergy / static_cast<double>(integratedTotalCount)) - 10.f);
+
+        double gatedEnergy = 0.0;
+        juce::uint64 gatedCount = 0;
+        for( auto b = gateBin; b < numBins; ++b )
+        {
+            gatedEnergy += integratedEnergy[b];
+            gatedCount += integratedCounts[b];
+        }
+
+        snapshot.integratedLufs = gatedCount > 0 ? toLufs(gatedEnergy / static_cast<double>(gatedCount)) : silence;
+    }
+
+    void addShortTermValue(double energy, float lufs) noexcept
+    {
+        if( lufs < absoluteGateLufs )
+            return;
+
+        ++shortTermCounts[getBin(lufs)];
+        shortTermTotalEnergy += energy;
+        ++shortTermTotalCount;
+
+        //EBU Tech 3342: relative gate 20 LU down, LRA is the spread between the 10th and 95th percentile
+        const auto gateBin = getBin(toLufs(shortTermTotalEnergy / static_cast<double>(shortTermTotalCount)) - 20.f);
+
+        juce::uint64 gatedCount = 0;
+        for( auto b = gateBin; b < numBins; ++b )
+            gatedCount += shortTermCounts[b];
+
+        if( gatedCount == 0 )
+            return;
+
+        const auto lowRank = static_cast<juce::uint64>(0.10 * static_cast<double>(gatedCount - 1));
+        const auto highRank = static_cast<juce::uint64>(0.95 * static_cast<double>(gatedCount - 1));
+
+        juce::uint64 seen = 0;
+        size_t lowBin = gateBin, highBin = gateBin;
+        for( auto b = gateBin; b < numBins; ++b )
+        {
+            if( seen <= lowRank && lowRank < seen + shortTermCounts[b] )
+                lowBin = b;
+            if( seen <= highRank && highRank < seen + shortTermCounts[b] )
+            {
+                highBin = b;
+                break;
+            }
+            seen += shortTermCounts[b];
+        }
+
+        snapshot.loudnessRangeLu = getBinLufs(highBin) - getBinLufs(lowBin);
+    }
+
+    Biquad shelf, highpass;
+    std::vector<GroupState> groups;
+    size_t numChannels = 0;
+
+    int samplesPerStep = 4800, stepPosition = 0;
+    std::array<double, shortTermSteps> stepEnergy {};
+    size_t stepIndex = 0, numSteps = 0;
+
+    std::array<double, numBins> integratedEnergy {};
+    std::array<juce::uint64, numBins> integratedCounts {};
+    double integratedTotalEnergy = 0.0;
+    juce::uint64 integratedTotalCount = 0;
+
+    std::array<juce::uint64, numBins> shortTermCounts {};
+    double shortTermTotalEnergy = 0.0;
+    juce::uint64 shortTermTotalCount = 0;
+
+    Snapshot snapshot; //audio thread working copy
+    TripleBuffer<Snapshot> snapshots;
+};
+} //end namespace VoxDSP
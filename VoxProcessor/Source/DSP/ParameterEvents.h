@@ -0,0 +1,79 @@
+/*
+  ==============================================================================
+
+    ParameterEvents.h
+    Created: 16 Oct 2026 11:05:36pm
+    Author:  Morris Sound
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+namespace VoxDSP
+{
+/*
+ The timestamped parameter changes for one block, kept sorted by sample offset.
+ JUCE hands the processor one value per parameter per block. Where the host's sample accurate
+ automation reaches the processor (the CLAP build's direct events, VoxRender's benchmark) the
+ changes are added here on the audio thread before processBlock(), which splits the block at
+ their offsets and clears the list.
+ The list is allocated in prepare(), adding and clearing never allocates. When it is full
+ further events are dropped and add() returns false; the parameter still lands on its
+ final value at the next block.
+ */
+struct ParameterEventList
+{
+    struct Event
+    {
+        int sampleOffset = 0;
+        int parameterIndex = 0;
+        float value = 0.f;
+    };
+
+    void prepare(size_t capacity)
+    {
+        events.resize(capacity);
+        clear();
+    }
+
+    void clear() noexcept
+    {
+        numEvents = 0;
+        parameterMask = 0;
+    }
+
+    //audio thread. Events with the same offset keep the order they were added in.
+    bool add(int sampleOffset, int parameterIndex, float value) noexcept
+    {
+        jassert(parameterIndex >= 0 && parameterIndex < 32);
+        if( numEvents == events.size() )
+            return false;
+
+        sampleOffset = juce::jmax(0, sampleOffset);
+
+        //hosts send them in order, so this is an append nearly every time
+        auto i = numEvents++;
+        for( ; i > 0 && events[i - 1].sampleOffset > sampleOffset; --i )
+            events[i] = events[i - 1];
+
+        events[i] = { sampleOffset, parameterIndex, value };
+        parameterMask |= 1u << static_cast<juce::uint32>(parameterIndex);
+        return true;
+    }
+
+    const Event* begin() const noexcept { return events.data(); }
+    const Event* end() const noexcept { return events.data() + numEvents; }
+    size_t size() const noexcept { return numEvents; }
+
+    //one bit per parameterIndex that has at least one event in the list
+    juce::uint32 getParameterMask() const noexcept { return parameterMask; }
+
+private:
+    std::vector<Event> events;
+    size_t numEvents = 0;
+    juce::uint32 parameterMask = 0;
+};
+} //end namespace VoxDSP
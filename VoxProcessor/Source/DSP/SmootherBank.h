@@ -0,0 +1,101 @@
+/*
+  ==============================================================================
+
+    SmootherBank.h
+    Created: 16 Oct 2026 10:24:51pm
+    Author:  Morris Sound
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <bit>
+
+namespace VoxDSP
+{
+/*
+ NumSmoothers linear smoothers (the same ramps as juce::SmoothedValue<float>) kept as arrays:
+ currents, targets, steps and remaining sample counts side by side, so advancing all of them is
+ one branch free loop the compiler vectorizes.
+ A bit per smoother marks the ones still moving. Only the span between the lowest and the highest
+ moving smoother is walked, and nothing at all while every smoother sits on its target.
+ Nothing allocates after construction.
+ */
+template<size_t NumSmoothers>
+struct SmootherBank
+{
+    static_assert(NumSmoothers > 0 && NumSmoothers <= 32, "the moving smoothers are tracked in a 32 bit mask");
+
+    void reset(double sampleRate, double rampLengthSeconds) noexcept
+    {
+        stepsToTarget = static_cast<int>(std::floor(rampLengthSeconds * sampleRate));
+        for( size_t i = 0; i < NumSmoothers; ++i )
+            setCurrentAndTargetValue(i, target[i]);
+    }
+
+    void setCurrentAndTargetValue(size_t index, float value) noexcept
+    {
+        current[index] = value;
+        target[index] = value;
+        step[index] = 0.f;
+        remaining[index] = 0;
+        moving &= ~(1u << index);
+    }
+
+    void setTargetValue(size_t index, float value) noexcept
+    {
+        if( value == target[index] )
+            return;
+
+        if( stepsToTarget <= 0 )
+        {
+            setCurrentAndTargetValue(index, value);
+            return;
+        }
+
+        target[index] = value;
+        remaining[index] = stepsToTarget;
+        step[index] = (value - current[index]) / static_cast<float>(stepsToTarget);
+        moving |= 1u << index;
+    }
+
+    //Advances every moving smoother by numSamples.
+    void skip(int numSamples) noexcept
+    {
+        if( moving == 0 )
+            return;
+
+        const auto first = static_cast<size_t>(std::countr_zero(moving));
+        const auto last = static_cast<size_t>(std::bit_width(moving));
+
+        for( auto i = first; i < last; ++i )
+        {
+            //smoothers that already arrived have remaining == 0 and step == 0, and keep their value
+            const auto n = std::min(remaining[i], numSamples);
+            remaining[i] -= n;
+            current[i] = remaining[i] == 0 ? target[i] : current[i] + step[i] * static_cast<float>(n);
+        }
+
+        for( auto i = first; i < last; ++i )
+        {
+            if( remaining[i] == 0 )
+                moving &= ~(1u << i);
+        }
+    }
+
+    float getCurrentValue(size_t index) const noexcept { return current[index]; }
+    float getTargetValue(size_t index) const noexcept { return target[index]; }
+    bool isSmoothing(size_t index) const noexcept { return (moving & (1u << index)) != 0; }
+    bool isAnySmoothing() const noexcept { return moving != 0; }
+
+private:
+    alignas(32) std::array<float, NumSmoothers> current {};
+    alignas(32) std::array<float, NumSmoothers> target {};
+    alignas(32) std::array<float, NumSmoothers> step {};
+    alignas(32) std::array<int, NumSmoothers> remaining {};
+    juce::uint32 moving = 0;
+    int stepsToTarget = 0;
+};
+} //end namespace VoxDSP
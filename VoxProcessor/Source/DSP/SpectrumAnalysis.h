@@ -0,0 +1,317 @@
+/*
+  ==============================================================================
+
+    SpectrumAnalysis.h
+    Created: 16 Oct 2026 11:48:13pm
+    Author:  Morris Sound
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "TripleBuffer.h"
+
+namespace VoxDSP
+{
+/*
+ Spectrum analysis off the audio thread, for one trace. The thread it runs on is SpectrumAnalysisBank's.
+ The audio thread copies its block into a lock-free ring, one copy per channel.
+ Once a display frame's worth of samples has arrived, push() asks for the worker, which takes whatever arrived
+ since, so however small the host blocks are there is one FFT per frame. It windows the newest fftSize samples,
+ runs juce::dsp::FFT (vDSP, IPP or FFTW where the build has them), folds the bins into numPoints log spaced points
+ and applies the ballistics. The points are published through a TripleBuffer as y positions, the GUI only scales and draws them.
+ */
+struct SpectrumAnalysis
+{
+    static constexpr size_t numPoints = 256;
+    static constexpr size_t maxChannels = 2;
+    static constexpr float minFreqHz = 20.f, maxFreqHz = 20000.f;
+    static constexpr float minDb = -90.f, maxDb = 0.f;
+
+    struct Snapshot
+    {
+        //0 at maxDb, 1 at minDb. Point i sits at getNormalisedX() of getPointFrequency(i).
+        std::array<std::array<float, numPoints>, maxChannels> y {};
+        size_t numChannels = 0;
+    };
+
+    //0 at minFreqHz, 1 at maxFreqHz, log spaced
+    static float getNormalisedX(float freqHz) noexcept
+    {
+        return std::log(freqHz / minFreqHz) / std::log(maxFreqHz / minFreqHz);
+    }
+
+    static float getPointFrequency(double point) noexcept
+    {
+        return static_cast<float>(minFreqHz * std::pow(maxFreqHz / minFreqHz, point / static_cast<double>(numPoints - 1)));
+    }
+
+    //while the audio thread and the worker are stopped
+    void prepare(double newSampleRate, int numChannelsToAnalyse)
+    {
+        sampleRate = newSampleRate;
+        numChannels = static_cast<size_t>(juce::jlimit(1, static_cast<int>(maxChannels), numChannelsToAnalyse));
+
+        //bins of 12Hz at most, whatever the sample rate
+        auto order = 12;
+        while( sampleRate / (1 << order) > 12.0 && order < 15 )
+            ++order;
+
+        fft = std::make_unique<juce::dsp::FFT>(order);
+        fftSize = fft->getSize();
+        window = std::make_unique<juce::dsp::WindowingFunction<float>>(static_cast<size_t>(fftSize),
+                                                                        juce::dsp::WindowingFunction<float>::blackmanHarris);
+        fftData.assign(static_cast<size_t>(fftSize) * 2, 0.f);
+
+        ring.setSize(static_cast<int>(numChannels), ringSizeInFrames * fftSize);
+        ring.clear();
+        fifo.setTotalSize(ring.getNumSamples());
+        history.setSize(static_cast<int>(numChannels), fftSize);
+        history.clear();
+        historyPosition = 0;
+        samplesPerFrame = juce::jmax(1, juce::roundToInt(sampleRate * frameIntervalMs / 1000.0));
+        samplesSinceFrame = 0;
+
+        //a point takes the loudest bin up to halfway to its neighbours,
+        //or is interpolated where that range is narrower than two bins
+        const auto binWidth = sampleRate / fftSize;
+        const auto maxBin = fftSize / 2;
+        for( size_t i = 0; i < numPoints; ++i )
+        {
+            auto& bins = pointBins[i];
+            bins.first = juce::jlimit(0, maxBin, static_cast<int>(std::ceil(getPointFrequency(i - 0.5) / binWidth)));
+            bins.last = juce::jlimit(0, maxBin, static_cast<int>(std::floor(getPointFrequency(i + 0.5) / binWidth)));
+            bins.position = juce::jlimit(0.f, static_cast<float>(maxBin - 1), static_cast<float>(getPointFrequency(i) / binWidth));
+        }
+    }
+
+    bool isPrepared() const noexcept { return fftSize > 0; }
+
+    //audio thread. Returns true when a display frame's worth of samples has arrived since the last time it did.
+    bool push(juce::dsp::AudioBlock<const float> block) noexcept
+    {
+        if( fftSize == 0 || block.getNumChannels() == 0 )
+            return false;
+
+        //when the worker falls behind the end of the block is dropped, the next frame is whole again
+        const auto numSamples = static_cast<int>(block.getNumSamples());
+        const auto scope = fifo.write(numSamples);
+        for( size_t ch = 0; ch < numChannels; ++ch )
+        {
+            //a block with fewer channels than prepared repeats its last one
+            const auto* source = block.getChannelPointer(juce::jmin(ch, block.getNumChannels() - 1));
+            auto* dest = ring.getWritePointer(static_cast<int>(ch));
+            if( scope.blockSize1 > 0 )
+                juce::FloatVectorOperations::copy(dest + scope.startIndex1, source, scope.blockSize1);
+            if( scope.blockSize2 > 0 )
+                juce::FloatVectorOperations::copy(dest + scope.startIndex2, source + scope.blockSize1, scope.blockSize2);
+        }
+
+        samplesSinceFrame += numSamples;
+        if( samplesSinceFrame < samplesPerFrame )
+            return false;
+
+        samplesSinceFrame = 0;
+        return true;
+    }
+
+    //while the worker is stopped. The ballistics start from the floor.
+    void resetLevels() noexcept
+    {
+        for( auto& l : levels )
+            l.fill(minDb);
+    }
+
+    //worker. Analyses whatever arrived since the last frame, if anything did.
+    void analyseNewSamples()
+    {
+        if( auto numNewSamples = readRing(); numNewSamples > 0 )
+            analyse(static_cast<float>(numNewSamples / sampleRate));
+    }
+
+    //GUI thread. Returns true when a newer snapshot was picked up.
+    bool pullSnapshot() noexcept { return snapshots.update(); }
+
+    //GUI thread. The snapshot picked up by the last pullSnapshot().
+    const Snapshot& getSnapshot() const noexcept { return snapshots.read(); }
+
+private:
+    static constexpr int ringSizeInFrames = 4;
+    static constexpr double frameIntervalMs = 16.0;
+    static constexpr float releaseDbPerSecond = 48.f;
+
+    struct PointBins
+    {
+        int first = 0, last = 0;
+        float position = 0.f;
+    };
+
+    int readRing()
+    {
+        const auto numReady = fifo.getNumReady();
+        const auto scope = fifo.read(numReady);
+        appendToHistory(scope.startIndex1, scope.blockSize1);
+        appendToHistory(scope.startIndex2, scope.blockSize2);
+        return numReady;
+    }
+
+    void appendToHistory(int ringStart, int numSamples)
+    {
+        //only the last fftSize samples are ever analysed
+        if( numSamples > fftSize )
+        {
+            ringStart += numSamples - fftSize;
+            numSamples = fftSize;
+        }
+
+        while( numSamples > 0 )
+        {
+            const auto n = juce::jmin(numSamples, fftSize - historyPosition);
+            for( int ch = 0; ch < history.getNumChannels(); ++ch )
+                juce::FloatVectorOperations::copy(history.getWritePointer(ch, historyPosition), ring.getReadPointer(ch, ringStart), n);
+
+            historyPosition = (historyPosition + n) % fftSize;
+            ringStart += n;
+            numSamples -= n;
+        }
+    }
+
+    void analyse(float elapsedSeconds)
+    {
+        const auto decayDb = releaseDbPerSecond * elapsedSeconds;
+        const auto toFullScale = 2.f / static_cast<float>(fftSize);
+        auto* data = fftData.data();
+
+        Snapshot snapshot;
+        snapshot.numChannels = numChannels;
+        for( size_t ch = 0; ch < numChannels; ++ch )
+        {
+            //oldest sample first
+            const auto* h = history.getReadPointer(static_cast<int>(ch));
+            std::copy(h + historyPosition, h + fftSize, data);
+            std::copy(h, h + historyPosition, data + (fftSize - historyPosition));
+
+            window->multiplyWithWindowingTable(data, static_cast<size_t>(fftSize));
+            fft->performFrequencyOnlyForwardTransform(data, true);
+
+            for( size_t i = 0; i < numPoints; ++i )
+            {
+                const auto& bins = pointBins[i];
+                float magnitude;
+                if( bins.last > bins.first )
+                {
+                    magnitude = *std::max_element(data + bins.first, data + bins.last + 1);
+                }
+                else
+                {
+                    const auto bin = static_cast<int>(bins.position);
+                    magnitude = juce::jmap(bins.position - static_cast<float>(bin), data[bin], data[bin + 1]);
+                }
+
+                //instant attack, falling at releaseDbPerSecond
+                auto& level = levels[ch][i];
+                level = juce::jmax(juce::Decibels::gainToDecibels(magnitude * toFullScale, minDb), level - decayDb);
+                snapshot.y[ch][i] = juce::jmap(juce::jlimit(minDb, maxDb, level), minDb, maxDb, 1.f, 0.f);
+            }
+        }
+
+        snapshots.write(snapshot);
+    }
+
+    double sampleRate = 44100.0;
+    size_t numChannels = 0;
+    int fftSize = 0;
+
+    //audio thread -> worker
+    juce::AbstractFifo fifo { 1 };
+    juce::AudioBuffer<float> ring;
+    int samplesPerFrame = 1, samplesSinceFrame = 0; //audio thread
+
+    //worker
+    std::unique_ptr<juce::dsp::FFT> fft;
+    std::unique_ptr<juce::dsp::WindowingFunction<float>> window;
+    std::vector<float> fftData;
+    juce::AudioBuffer<float> history;
+    int historyPosition = 0;
+    std::array<PointBins, numPoints> pointBins;
+    std::array<std::array<float, numPoints>, maxChannels> levels {};
+
+    //worker -> GUI
+    TripleBuffer<Snapshot> snapshots;
+};
+
+/*
+ NumTraces spectrum analyses and the one worker thread they share.
+ The worker sleeps until push() tells it a display frame's worth of samples has arrived for one of the traces,
+ then analyses every trace that has new samples. Nothing pushed, nothing woken, so a processor whose editor
+ is closed or whose transport is stopped costs no wakeups at all.
+ */
+template<size_t NumTraces>
+struct SpectrumAnalysisBank : private juce::Thread
+{
+    SpectrumAnalysisBank() : juce::Thread("Vox Spectrum Analysis") {}
+    ~SpectrumAnalysisBank() override { stopThread(1000); }
+
+    SpectrumAnalysis& operator[](size_t trace) noexcept { return traces[trace]; }
+    const SpectrumAnalysis& operator[](size_t trace) const noexcept { return traces[trace]; }
+
+    //while the audio thread is stopped (prepareToPlay). The worker is restarted if it was running.
+    void prepare(double sampleRate, int numChannelsToAnalyse)
+    {
+        stopThread(1000);
+
+        for( auto& t : traces )
+            t.prepare(sampleRate, numChannelsToAnalyse);
+
+        if( running )
+            startWorker();
+    }
+
+    //message thread
+    void start()
+    {
+        running = true;
+        if( traces.front().isPrepared() && ! isThreadRunning() )
+            startWorker();
+    }
+
+    //message thread. Blocks until the worker has finished its frame.
+    void stop()
+    {
+        running = false;
+        stopThread(1000);
+    }
+
+    //audio thread
+    void push(size_t trace, juce::dsp::AudioBlock<const float> block) noexcept
+    {
+        if( running.load(std::memory_order_relaxed) && traces[trace].push(block) )
+            notify();
+    }
+
+private:
+    void startWorker()
+    {
+        for( auto& t : traces )
+            t.resetLevels();
+
+        startThread();
+    }
+
+    void run() override
+    {
+        while( ! threadShouldExit() )
+        {
+            wait(-1);
+
+            for( auto& t : traces )
+                t.analyseNewSamples();
+        }
+    }
+
+    std::array<SpectrumAnalysis, NumTraces> traces;
+    std::atomic<bool> running { false };
+};
+} //end namespace VoxDSP
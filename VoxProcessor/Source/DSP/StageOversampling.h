@@ -0,0 +1,198 @@
+/*
+  ==============================================================================
+
+    StageOversampling.h
+    Created: 16 Oct 2026 6:21:47pm
+    Author:  Morris Sound
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+namespace VoxDSP
+{
+/*
+ Runs one nonlinear stage at 2x, 4x or 8x the host rate.
+ Only the filters of the selected mode are built. prepare() builds them for the mode selected at the time,
+ a later mode change is built with prepareMode() on the message thread and picked up by the audio thread
+ with switchToPreparedMode(), so the audio thread never allocates and the modes nobody uses take no memory.
+ The polyphase IIR filters are the low latency choice, the equiripple FIR filters are linear phase.
+ While the stage is bypassed, processBypassed() delays the signal by the same latency, so the
+ latency reported to the host doesn't change when the stage is switched on and off.
+ */
+struct StageOversampling
+{
+    enum class Mode
+    {
+        Off,
+        IIR2x,
+        IIR4x,
+        IIR8x,
+        FIR2x,
+        FIR4x,
+        FIR8x,
+        END_OF_LIST
+    };
+
+    static juce::StringArray getModeNames()
+    {
+        return
+        {
+            "Off",
+            "2x IIR",
+            "4x IIR",
+            "8x IIR",
+            "2x FIR",
+            "4x FIR",
+            "8x FIR",
+        };
+    }
+
+    //While the audio thread is stopped. Builds the filters of newMode and drops everything else.
+    void prepare(const juce::dsp::ProcessSpec& spec, Mode newMode)
+    {
+        hostSpec = spec;
+        prepared.reset();
+        retired.reset();
+
+        if( newMode == Mode::END_OF_LIST )
+            newMode = Mode::Off;
+
+        current = createRate(newMode);
+        preparedMode = newMode;
+    }
+
+    void reset() noexcept
+    {
+        if( current != nullptr )
+            current->reset();
+    }
+
+    /*
+     Message thread, and only while the audio thread can't be in switchToPreparedMode(): the owner hands
+     the prepared filters over with a flag. Frees the filters the audio thread switched away from, then builds
+     the ones for newMode unless they are already built. Returns true when something new was built.
+     */
+    bool prepareMode(Mode newMode)
+    {
+        retired.reset();
+
+        if( newMode == preparedMode || newMode == Mode::END_OF_LIST )
+            return false;
+
+        prepared = createRate(newMode);
+        preparedMode = newMode;
+        return true;
+    }
+
+    /*
+     Audio thread. Switches to the filters prepareMode() built, they start from silence.
+     The old ones are kept until the next prepareMode(). Returns true when the mode changed.
+     */
+    bool switchToPreparedMode() noexcept
+    {
+        if( prepared == nullptr )
+            return false;
+
+        jassert(retired == nullptr);
+        retired = std::exchange(current, std::move(prepared));
+        return true;
+    }
+
+    Mode getMode() const noexcept { return current != nullptr ? current->mode : Mode::Off; }
+    size_t getFactor() const noexcept { return size_t(1) << getFactorLog2(getMode()); }
+    int getLatencyInSamples() const noexcept { return current != nullptr ? current->latency : 0; }
+
+    /*
+     Upsamples the block, hands the oversampled block to processOversampled(block) and downsamples the result back.
+     With oversampling off the block is handed over as is.
+     */
+    template<typename ProcessOversampled>
+    void process(juce::dsp::AudioBlock<float> block, ProcessOversampled&& processOversampled) noexcept
+    {
+        auto* oversampler = current != nullptr ? current->oversampler.get() : nullptr;
+        if( oversampler == nullptr )
+        {
+            processOversampled(block);
+            return;
+        }
+
+        auto oversampled = oversampler->processSamplesUp(block);
+        processOversampled(oversampled);
+        oversampler->processSamplesDown(block);
+    }
+
+    void processBypassed(juce::dsp::AudioBlock<float> block) noexcept
+    {
+        if( current == nullptr || current->oversampler == nullptr )
+            return;
+
+        current->compensation.process(juce::dsp::ProcessContextReplacing<float>(block));
+    }
+
+private:
+    //the filters of one mode, with the delay that stands in for them while the stage is bypassed
+    struct Rate
+    {
+        Mode mode = Mode::Off;
+        std::unique_ptr<juce::dsp::Oversampling<float>> oversampler; //nullptr when off
+        juce::dsp::DelayLine<float, juce::dsp::DelayLineInterpolationTypes::None> compensation;
+        int latency = 0;
+
+        void reset() noexcept
+        {
+            if( oversampler != nullptr )
+                oversampler->reset();
+
+            compensation.reset();
+        }
+    };
+
+    std::unique_ptr<Rate> createRate(Mode m) const
+    {
+        auto rate = std::make_unique<Rate>();
+        rate->mode = m;
+        if( m != Mode::Off )
+        {
+            auto type = m >= Mode::FIR2x ? juce::dsp::Oversampling<float>::filterHalfBandFIREquiripple
+                                         : juce::dsp::Oversampling<float>::filterHalfBandPolyphaseIIR;
+
+            rate->oversampler = std::make_unique<juce::dsp::Oversampling<float>>(hostSpec.numChannels,
+                                                                                getFactorLog2(m),
+                                                                                type,
+                                                                                true,
+                                                                                true);
+            rate->oversampler->initProcessing(hostSpec.maximumBlockSize);
+            rate->latency = juce::roundToInt(rate->oversampler->getLatencyInSamples());
+
+            rate->compensation.setMaximumDelayInSamples(juce::jmax(1, rate->latency));
+            rate->compensation.prepare(hostSpec);
+            rate->compensation.setDelay(static_cast<float>(rate->latency));
+        }
+
+        rate->reset();
+        return rate;
+    }
+
+    static size_t getFactorLog2(Mode m) noexcept
+    {
+        switch (m)
+        {
+            case Mode::IIR2x: case Mode::FIR2x: return 1;
+            case Mode::IIR4x: case Mode::FIR4x: return 2;
+            case Mode::IIR8x: case Mode::FIR8x: return 3;
+            case Mode::Off: case Mode::END_OF_LIST: break;
+        }
+        return 0;
+    }
+
+    juce::dsp::ProcessSpec hostSpec {};
+    std::unique_ptr<Rate> current;  //audio thread
+    std::unique_ptr<Rate> prepared; //built by prepareMode(), taken by switchToPreparedMode()
+    std::unique_ptr<Rate> retired;  //switched away from, freed by the next prepareMode()
+    Mode preparedMode = Mode::Off;  //message thread, the mode of the newest filters
+};
+} //end namespace VoxDSP
@@ -0,0 +1,55 @@
+/*
+  ==============================================================================
+
+    TripleBuffer.h
+    Created: 16 Oct 2026 4:12:40pm
+    Author:  Morris Sound
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+namespace VoxDSP
+{
+/*
+ Lock-free handoff of the latest value from one writer thread to one reader thread.
+ The writer fills its own slot and swaps it with the shared middle slot, the reader swaps
+ the middle slot for its own only when something new was published. Neither side ever waits,
+ intermediate values the reader never got to are simply overwritten.
+ */
+template<typename T>
+struct TripleBuffer
+{
+    //writer thread
+    void write(const T& value) noexcept
+    {
+        buffers[writeIndex] = value;
+        writeIndex = middle.exchange(writeIndex | newDataFlag, std::memory_order_acq_rel) & indexMask;
+    }
+
+    //reader thread. Returns true when a newer value was picked up.
+    bool update() noexcept
+    {
+        if( (middle.load(std::memory_order_relaxed) & newDataFlag) == 0 )
+            return false;
+
+        readIndex = middle.exchange(readIndex, std::memory_order_acq_rel) & indexMask;
+        return true;
+    }
+
+    //reader thread. The value picked up by the last successful update().
+    const T& read() const noexcept { return buffers[readIndex]; }
+
+private:
+    static constexpr int indexMask = 0x3;
+    static constexpr int newDataFlag = 0x4;
+
+    std::array<T, 3> buffers {};
+    std::atomic<int> middle { 1 };
+    int writeIndex = 0;
+    int readIndex = 2;
+};
+} //end namespace VoxDSP
@@ -414,6 +414,476 @@ void ExtendedTabbedButtonBar::currentTabChanged(int newCurrentTabIndex, const ju
     });
 }
 
+//============== FRAME STATS =======================================================
+
+void FrameStats::addFrame(double timestampMs)
+{
+    if( numFrames > 0 )
+    {
+        const auto interval = timestampMs - lastFrameMs;
+        const auto isLate = interval > refreshIntervalMs * 1.5;
+        if( refreshIntervalMs <= 0.0 )
+            refreshIntervalMs = interval;
+        else if( ! isLate )
+            refreshIntervalMs += (interval - refreshIntervalMs) * 0.1;
+        else if( interval < 1000.0 ) //longer is a pause, not a drop
+            numDroppedFrames += juce::roundToInt(interval / refreshIntervalMs) - 1;
+    }
+    
+    lastFrameMs = timestampMs;
+    ++numFrames;
+}
+
+void FrameStats::addTime(Source source, double ms)
+{
+    auto& t = times[static_cast<size_t>(source)];
+    ++t.count;
+    t.lastMs = ms;
+    t.maxMs = juce::jmax(t.maxMs, ms);
+    t.totalMs += ms;
+}
+
+void FrameStats::reset()
+{
+    *this = FrameStats();
+}
+
+juce::String FrameStats::getName(Source source)
+{
+    switch(source)
+    {
+        case Source::InputMeter:
+            return "Input Meter";
+        case Source::OutputMeter:
+            return "Output Meter";
+        case Source::Loudness:
+            return "Loudness";
+        case Source::Analyzer:
+            return "Analyzer";
+        case Source::Update:
+            return "Update";
+        case Source::END_OF_LIST:
+            jassertfalse;
+    }
+    
+    return "NO SELECTION";
+}
+
+juce::String FrameStats::toString() const
+{
+    auto text = "frames " + juce::String(numFrames)
+                + "  dropped " + juce::String(numDroppedFrames)
+                + "  refresh " + juce::String(refreshIntervalMs, 1) + "ms";
+    
+    for( size_t i = 0; i < numSources; ++i )
+    {
+        const auto& t = times[i];
+        text << "\n" << getName(static_cast<Source>(i)).paddedRight(' ', 13)
+             << "last " << juce::String(t.lastMs, 2)
+             << "  avg " << juce::String(t.getAverageMs(), 2)
+             << "  max " << juce::String(t.maxMs, 2) << "ms";
+    }
+    
+    return text;
+}
+
+juce::var FrameStats::toVar() const
+{
+    auto* obj = new juce::DynamicObject();
+    obj->setProperty("frames", numFrames);
+    obj->setProperty("droppedFrames", numDroppedFrames);
+    obj->setProperty("refreshIntervalMs", refreshIntervalMs);
+    
+    for( size_t i = 0; i < numSources; ++i )
+    {
+        const auto& t = times[i];
+        auto* source = new juce::DynamicObject();
+        source->setProperty("count", t.count);
+        source->setProperty("avgMs", t.getAverageMs());
+        source->setProperty("maxMs", t.maxMs);
+        obj->setProperty(juce::Identifier(getName(static_cast<Source>(i)).removeCharacters(" ")), source);
+    }
+    
+    return obj;
+}
+
+FrameStatsOverlay::FrameStatsOverlay(const FrameStats& s) : stats(s), text(s.toString())
+{
+    setInterceptsMouseClicks(false, false);
+}
+
+void FrameStatsOverlay::paint(juce::Graphics& g)
+{
+    g.setColour(juce::Colours::black.withAlpha(0.7f));
+    g.fillRoundedRectangle(getLocalBounds().toFloat(), 4.f);
+    
+    g.setColour(juce::Colours::lightgreen);
+    g.setFont(juce::Font(juce::Font::getDefaultMonospacedFontName(), 11.f, juce::Font::plain));
+    g.drawFittedText(text, getLocalBounds().reduced(6, 4), juce::Justification::topLeft, static_cast<int>(FrameStats::numSources) + 1);
+}
+
+void FrameStatsOverlay::update(double timestampMs)
+{
+    if( timestampMs - lastRefreshMs < refreshIntervalMs )
+        return;
+    
+    lastRefreshMs = timestampMs;
+    text = stats.toString();
+    repaint();
+}
+
+//============== END OF FRAME STATS ================================================
+
+//============== METERS =======================================================
+
+LevelMeterDisplay::LevelMeterDisplay(VoxDSP::LevelMeter& m, const juce::String& labelText) : meter(m), label(labelText)
+{
+    setOpaque(true);
+}
+
+void LevelMeterDisplay::paintDisplay(juce::Graphics& g)
+{
+    background.draw(g, getLocalBounds(), [this](juce::Graphics& bg) { renderBackground(bg); });
+    
+    for( size_t b = 0; b < numBars; ++b )
+    {
+        const auto& area = barAreas[b];
+        const auto& position = drawn[b];
+        const auto zeroY = getY(0.f, area);
+        
+        //green up to 0dBFS, red above it
+        g.setColour(juce::Colours::green);
+        g.fillRect(area.withTop(juce::jmax(position.rmsY, zeroY)));
+        if( position.rmsY < zeroY )
+        {
+            g.setColour(juce::Colours::red);
+            g.fillRect(area.withTop(position.rmsY).withBottom(zeroY));
+        }
+        
+        //true peak hold, pinned to the top of the scale when it goes past it
+        g.setColour(position.holdIsOver ? juce::Colours::red : juce::Colours::whitesmoke);
+        g.fillRect(area.withTop(position.holdY).withHeight(1));
+    }
+}
+
+void LevelMeterDisplay::resized()
+{
+    background.invalidate();
+    
+    auto rect = getLocalBounds().reduced(2, 2);
+    rect.removeFromBottom(fontHeight);
+    rect.removeFromTop(fontHeight / 2);
+    
+    meterArea = rect;
+    barAreas[0] = rect.removeFromLeft(meterChanWidth);
+    barAreas[1] = rect.removeFromRight(meterChanWidth);
+    
+    drawn = getBarPositions();
+}
+
+bool LevelMeterDisplay::update()
+{
+    if( ! meter.pullSnapshot() )
+        return false;
+    
+    const auto positions = getBarPositions();
+    auto changed = false;
+    for( size_t b = 0; b < numBars; ++b )
+    {
+        if( positions[b] == drawn[b] )
+            continue;
+        
+        //only the rows between where the RMS was and where it is now, and the old and new hold lines
+        const auto& area = barAreas[b];
+        auto repaintRows = [this, &area](int y1, int y2)
+        {
+            repaint(area.withTop(juce::jmin(y1, y2)).withBottom(juce::jmax(y1, y2) + 1));
+        };
+        
+        if( positions[b].rmsY != drawn[b].rmsY )
+            repaintRows(drawn[b].rmsY, positions[b].rmsY);
+        
+        if( positions[b].holdY != drawn[b].holdY || positions[b].holdIsOver != drawn[b].holdIsOver )
+        {
+            repaintRows(drawn[b].holdY, drawn[b].holdY);
+            repaintRows(positions[b].holdY, positions[b].holdY);
+        }
+        
+        drawn[b] = positions[b];
+        changed = true;
+    }
+    
+    return changed;
+}
+
+int LevelMeterDisplay::getY(float decibels, const juce::Rectangle<int>& area) const
+{
+    return juce::roundToInt(juce::jmap<float>(juce::jlimit<float>(NEGATIVE_INFINITY, MAX_DECIBELS, decibels),
+                                              NEGATIVE_INFINITY,
+                                              MAX_DECIBELS,
+                                              static_cast<float>(area.getBottom()),
+                                              static_cast<float>(area.getY())));
+}
+
+std::array<LevelMeterDisplay::BarPosition, LevelMeterDisplay::numBars> LevelMeterDisplay::getBarPositions() const
+{
+    //the bars show the first two channels, a mono bus shows its one channel on both
+    const auto& snapshot = meter.getSnapshot();
+    std::array<BarPosition, numBars> positions;
+    for( size_t b = 0; b < numBars; ++b )
+    {
+        const auto& reading = snapshot.channels[snapshot.numChannels > b ? b : 0];
+        positions[b].rmsY = getY(juce::Decibels::gainToDecibels(reading.rms), barAreas[b]);
+        positions[b].holdY = getY(juce::Decibels::gainToDecibels(reading.truePeakHold), barAreas[b]);
+        positions[b].holdIsOver = reading.truePeakHold > 1.0f;
+    }
+    
+    return positions;
+}
+
+void LevelMeterDisplay::renderBackground(juce::Graphics& g)
+{
+    g.fillAll(getLookAndFeel().findColour(juce::ResizableWindow::backgroundColourId));
+    
+    auto rect = getLocalBounds();
+    g.setColour(juce::Colours::teal);
+    g.drawRect(rect);
+    rect.reduce(2,2);
+    
+    g.setColour(juce::Colours::whitesmoke);
+    g.drawText(label, rect.removeFromBottom(fontHeight), juce::Justification::centred);
+    
+    g.setColour(juce::Colours::black);
+    for( const auto& area : barAreas )
+        g.fillRect(area);
+    
+    const auto leftMeterRightEdge = barAreas[0].getRight();
+    const auto rightMeterLeftEdge = barAreas[1].getX();
+    for (int i = MAX_DECIBELS; i >= NEGATIVE_INFINITY; i-=12)
+    {
+        auto y = juce::jmap<int>(i, NEGATIVE_INFINITY, MAX_DECIBELS, meterArea.getBottom(), meterArea.getY());
+        auto r = juce::Rectangle<int>(meterArea.getWidth(), fontHeight);
+        r.setCentre(meterArea.getCentreX(), y);
+        
+        g.setColour(i == 0 ? juce::Colours::whitesmoke :
+                    i > 0 ? juce::Colours::red :
+                    juce::Colours::teal);
+        g.drawFittedText(juce::String(i), r, juce::Justification::centred, 1);
+        
+        if (i != MAX_DECIBELS && i != NEGATIVE_INFINITY)
+        {
+            g.drawLine(meterArea.getX() + tickIndent, y, leftMeterRightEdge - tickIndent, y);
+            g.drawLine(rightMeterLeftEdge + tickIndent, y, meterArea.getRight() - tickIndent, y);
+        }
+    }
+}
+
+LoudnessReadout::LoudnessReadout(VoxDSP::LoudnessMeter& m) : meter(m), text(getText(m.getSnapshot()))
+{
+    setOpaque(true);
+}
+
+void LoudnessReadout::paintDisplay(juce::Graphics& g)
+{
+    g.fillAll(getLookAndFeel().findColour(juce::ResizableWindow::backgroundColourId));
+    g.setColour(juce::Colours::whitesmoke);
+    g.setFont(15.0f);
+    g.drawFittedText(text, getLocalBounds(), juce::Justification::centred, 1);
+}
+
+bool LoudnessReadout::update()
+{
+    if( ! meter.pullSnapshot() )
+        return false;
+    
+    auto newText = getText(meter.getSnapshot());
+    if( newText == text )
+        return false;
+    
+    text = std::move(newText);
+    repaint();
+    return true;
+}
+
+juce::String LoudnessReadout::getText(const VoxDSP::LoudnessMeter::Snapshot& loudness)
+{
+    auto formatLoudness = [](float value)
+    {
+        return std::isfinite(value) ? juce::String(value, 1) : juce::String("-inf");
+    };
+    
+    return "M " + formatLoudness(loudness.momentaryLufs)
+           + "   S " + formatLoudness(loudness.shortTermLufs)
+           + "   I " + formatLoudness(loudness.integratedLufs) + " LUFS"
+           + "   LRA " + juce::String(loudness.loudnessRangeLu, 1) + " LU";
+}
+
+//============== END OF METERS ================================================
+
+//============== SPECTRUM DISPLAY =======================================================
+
+SpectrumDisplay::SpectrumDisplay(Analyses& a) : analyses(a)
+{
+    setOpaque(true);
+    line.preallocateSpace(static_cast<int>(VoxDSP::SpectrumAnalysis::numPoints) * 3 + 3);
+}
+
+void SpectrumDisplay::paintDisplay(juce::Graphics& g)
+{
+    using Analysis = VoxDSP::SpectrumAnalysis;
+    grid.draw(g, getLocalBounds(), [this](juce::Graphics& bg) { renderGrid(bg); });
+    
+    //left and right of each trace
+    const std::array<std::array<juce::Colour, Analysis::maxChannels>, numTraces> colours
+    {{
+        {{ juce::Colours::skyblue, juce::Colours::lightyellow }},
+        {{ juce::Colours::orange, juce::Colours::hotpink }},
+    }};
+    
+    //the strokes are ready, filling them only rasterizes what is inside the clip
+    for( size_t t = 0; t < numTraces; ++t )
+    {
+        if( ! shown[t] )
+            continue;
+        
+        for( size_t ch = 0; ch < drawnNumChannels[t]; ++ch )
+        {
+            g.setColour(colours[t][ch]);
+            g.fillPath(strokes[t][ch]);
+        }
+    }
+}
+
+void SpectrumDisplay::renderGrid(juce::Graphics& g)
+{
+    using Analysis = VoxDSP::SpectrumAnalysis;
+    g.fillAll(juce::Colours::black);
+    
+    auto bounds = getLocalBounds().toFloat();
+    g.setFont(10.f);
+    for( auto freq : { 20.f, 50.f, 100.f, 200.f, 500.f, 1000.f, 2000.f, 5000.f, 10000.f, 20000.f } )
+    {
+        auto x = bounds.getX() + Analysis::getNormalisedX(freq) * bounds.getWidth();
+        g.setColour(juce::Colours::dimgrey);
+        g.drawVerticalLine(juce::roundToInt(x), bounds.getY(), bounds.getBottom());
+        
+        g.setColour(juce::Colours::lightgrey);
+        auto label = freq >= 1000.f ? juce::String(freq / 1000.f, 0) + "k" : juce::String(freq, 0);
+        g.drawText(label, juce::Rectangle<float>(x + 2.f, bounds.getY(), 30.f, 12.f), juce::Justification::left);
+    }
+    
+    for( auto db = Analysis::maxDb; db > Analysis::minDb; db -= 18.f )
+    {
+        auto y = juce::jmap(db, Analysis::minDb, Analysis::maxDb, bounds.getBottom(), bounds.getY());
+        g.setColour(juce::Colours::dimgrey);
+        g.drawHorizontalLine(juce::roundToInt(y), bounds.getX(), bounds.getRight());
+        
+        g.setColour(juce::Colours::lightgrey);
+        g.drawText(juce::String(db, 0), juce::Rectangle<float>(bounds.getRight() - 32.f, y, 30.f, 12.f), juce::Justification::right);
+    }
+}
+
+void SpectrumDisplay::resized()
+{
+    grid.invalidate();
+    for( size_t t = 0; t < numTraces; ++t )
+    {
+        for( size_t ch = 0; ch < drawnNumChannels[t]; ++ch )
+            buildStroke(t, ch);
+    }
+}
+
+bool SpectrumDisplay::update(const std::array<bool, numTraces>& tracesShown)
+{
+    auto changed = false;
+    for( size_t t = 0; t < numTraces; ++t )
+    {
+        if( shown[t] != tracesShown[t] )
+        {
+            shown[t] = tracesShown[t];
+            repaint();
+            changed = true;
+        }
+        
+        //a hidden trace keeps its last snapshot waiting, it is picked up when the trace comes back
+        if( ! shown[t] || ! analyses[t].pullSnapshot() )
+            continue;
+        
+        const auto& snapshot = analyses[t].getSnapshot();
+        if( snapshot.numChannels != drawnNumChannels[t] )
+        {
+            drawnNumChannels[t] = snapshot.numChannels;
+            repaint();
+            changed = true;
+        }
+        
+        for( size_t ch = 0; ch < snapshot.numChannels; ++ch )
+        {
+            //a settled or silent spectrum publishes the same points every frame
+            const auto changedArea = getChangedArea(drawnPoints[t][ch], snapshot.y[ch]);
+            if( changedArea.isEmpty() )
+                continue;
+            
+            drawnPoints[t][ch] = snapshot.y[ch];
+            buildStroke(t, ch);
+            repaint(changedArea);
+            changed = true;
+        }
+    }
+    
+    return changed;
+}
+
+void SpectrumDisplay::buildStroke(size_t trace, size_t channel)
+{
+    using Analysis = VoxDSP::SpectrumAnalysis;
+    const auto& y = drawnPoints[trace][channel];
+    const auto height = static_cast<float>(getHeight());
+    const auto dx = static_cast<float>(getWidth()) / static_cast<float>(Analysis::numPoints - 1);
+    
+    //clear() keeps the space, so the line doesn't allocate
+    line.clear();
+    line.startNewSubPath(0.f, y[0] * height);
+    for( size_t i = 1; i < Analysis::numPoints; ++i )
+        line.lineTo(static_cast<float>(i) * dx, y[i] * height);
+    
+    juce::PathStrokeType(1.f).createStrokedPath(strokes[trace][channel], line);
+}
+
+juce::Rectangle<int> SpectrumDisplay::getChangedArea(const Points& before, const Points& after) const
+{
+    const auto mismatch = std::mismatch(before.begin(), before.end(), after.begin());
+    if( mismatch.first == before.end() )
+        return {};
+    
+    auto first = static_cast<size_t>(std::distance(before.begin(), mismatch.first));
+    auto last = before.size() - 1;
+    while( before[last] == after[last] )
+        --last;
+    
+    //the segments either side of the changed points move with them
+    first = first > 0 ? first - 1 : 0;
+    last = juce::jmin(last + 1, before.size() - 1);
+    
+    auto top = 1.f, bottom = 0.f;
+    for( auto i = first; i <= last; ++i )
+    {
+        top = juce::jmin(top, before[i], after[i]);
+        bottom = juce::jmax(bottom, before[i], after[i]);
+    }
+    
+    const auto height = static_cast<float>(getHeight());
+    const auto dx = static_cast<float>(getWidth()) / static_cast<float>(before.size() - 1);
+    return juce::Rectangle<float>::leftTopRightBottom(static_cast<float>(first) * dx,
+                                                      top * height,
+                                                      static_cast<float>(last) * dx,
+                                                      bottom * height)
+        .expanded(2.f)
+        .getSmallestIntegerContainer();
+}
+
+//============== END OF SPECTRUM DISPLAY ================================================
+
 //============== DSP_GUI =======================================================
 
 DSP_Gui::DSP_Gui(VoxProcessorAudioProcessor& proc) : processor(proc)
@@ -548,6 +1018,26 @@ VoxProcessorAudioProcessorEditor::VoxProcessorAudioProcessorEditor (VoxProcessor
     addAndMakeVisible(outGainControl.get());
     
     addAndMakeVisible(analyzer);
+    addAndMakeVisible(inputMeterDisplay);
+    addAndMakeVisible(outputMeterDisplay);
+    addAndMakeVisible(loudnessReadout);
+    
+    inputMeterDisplay.setFrameStats(&frameStats, FrameStats::Source::InputMeter);
+    outputMeterDisplay.setFrameStats(&frameStats, FrameStats::Source::OutputMeter);
+    loudnessReadout.setFrameStats(&frameStats, FrameStats::Source::Loudness);
+    analyzer.setFrameStats(&frameStats, FrameStats::Source::Analyzer);
+    addChildComponent(frameStatsOverlay);
+    //cmd+shift+F toggles the overlay, see keyPressed()
+    setWantsKeyboardFocus(true);
+    
+    const auto tapParams = std::array { audioProcessor.analyzerTapA, audioProcessor.analyzerTapB };
+    for( size_t t = 0; t < SpectrumDisplay::numTraces; ++t )
+    {
+        auto& box = analyzerTapBoxes[t];
+        box.addItemList(tapParams[t]->choices, 1);
+        addAndMakeVisible(box);
+        analyzerTapAttachments[t] = std::make_unique<juce::ComboBoxParameterAttachment>(*tapParams[t], box);
+    }
     
     SimpleMBComp::addLabelPairs(inGainControl->labels, *audioProcessor.inputGain, "dB");
     SimpleMBComp::addLabelPairs(outGainControl->labels, *audioProcessor.outputGain, "dB");
@@ -555,10 +1045,15 @@ VoxProcessorAudioProcessorEditor::VoxProcessorAudioProcessorEditor (VoxProcessor
     inGainAttachment = std::make_unique<juce::SliderParameterAttachment>(*audioProcessor.inputGain, *inGainControl);
     outGainAttachment =  std::make_unique<juce::SliderParameterAttachment>(*audioProcessor.outputGain, *outGainControl);
     
+    addAndMakeVisible(autoGainButton);
+    addAndMakeVisible(autoGainHoldButton);
+    autoGainAttachment = std::make_unique<juce::ButtonParameterAttachment>(*audioProcessor.autoGain, autoGainButton);
+    autoGainHoldAttachment = std::make_unique<juce::ButtonParameterAttachment>(*audioProcessor.autoGainHold, autoGainHoldButton);
+    
     audioProcessor.guiNeedsLatestDspOrder.set(true);
     
     tabbedComponent.addListener(this);
-    startTimer(30);
+    startTimer(idleFrameIntervalMs);
     setSize (768, 450);
     
     //[DONE]: add bypass button to Tabs
@@ -585,124 +1080,27 @@ VoxProcessorAudioProcessorEditor::~VoxProcessorAudioProcessorEditor()
 //==============================================================================
 void VoxProcessorAudioProcessorEditor::paint (juce::Graphics& g)
 {
-    // (Our component is opaque, so we must completely fill the background with a solid colour)
-    g.fillAll (getLookAndFeel().findColour (juce::ResizableWindow::backgroundColourId));
-    
-    auto fillMeter = [&](auto rect, auto& rmsSource)
+    background.draw(g, getLocalBounds(), [this](juce::Graphics& bg)
     {
-        g.setColour(juce::Colours::black);
-        g.fillRect(rect);
+        // (Our component is opaque, so we must completely fill the background with a solid colour)
+        bg.fillAll (getLookAndFeel().findColour (juce::ResizableWindow::backgroundColourId));
         
-        auto rms = rmsSource.get();
-        if (rms > 1.0f)
-        {
-            g.setColour(juce::Colours::red);
-            //This defines a point at 0 dBFS
-            auto lowerLeft = juce::Point<float>(rect.getX(),
-                                                juce::jmap<float>
-                                                (juce::Decibels::gainToDecibels(1.f),
-                                                NEGATIVE_INFINITY,
-                                                MAX_DECIBELS,
-                                                rect.getBottom(),
-                                                rect.getY()));
-            //This defines a point at rms dBFS
-            auto upperRight = juce::Point<float>(rect.getRight(),
-                                                 juce::jmap<float>(juce::Decibels::gainToDecibels(rms),
-                                                NEGATIVE_INFINITY,
-                                                MAX_DECIBELS,
-                                                rect.getBottom(),
-                                                rect.getY()));
-            //This defines a rectangle using those points
-            auto overTHRect = juce::Rectangle<float>(lowerLeft, upperRight);
-            //This fills that rectangle in red
-            g.fillRect(overTHRect);
-        }
-        
-        //This clamps the rms level to 1.0, since the over-threshold if() draws everything over 0dBFS
-        rms = juce::jmin<float>(rms, 1.0);
-        g.setColour(juce::Colours::green);
-        //This draws the rectangle that represents the signal level below 0dBFS
-        g.fillRect(rect.withY(juce::jmap<float>(juce::Decibels::gainToDecibels(rms),
-                                                        NEGATIVE_INFINITY,
-                                                        MAX_DECIBELS,
-                                                        rect.getBottom(),
-                                                        rect.getY()))
-                           .withBottom(rect.getBottom()));
-    };
-    
-    auto drawTicks = [&](auto rect, auto leftMeterRightEdge, auto rightMeterLeftEdge)
-    {
-        for (int i = MAX_DECIBELS; i >= NEGATIVE_INFINITY; i-=12)
-        {
-            auto y = juce::jmap<int>(i, NEGATIVE_INFINITY, MAX_DECIBELS, rect.getBottom(), rect.getY());
-            auto r = juce::Rectangle<int>(rect.getWidth(), fontHeight);
-            r.setCentre(rect.getCentreX(), y);
-            
-            g.setColour(i == 0 ? juce::Colours::whitesmoke :
-                        i > 0 ? juce::Colours::red :
-                        juce::Colours::teal);
-            g.drawFittedText(juce::String(i), r, juce::Justification::centred, 1);
-            
-            if (i != MAX_DECIBELS && i != NEGATIVE_INFINITY)
-            {
-                g.drawLine(rect.getX() + tickIndent, y, leftMeterRightEdge - tickIndent, y);
-                g.drawLine(rightMeterLeftEdge + tickIndent, y, rect.getRight() - tickIndent, y);
-            }
-        }
-    };
-    
-    auto drawMeter = [&fillMeter, &drawTicks](auto rect, auto& g, const auto& leftSource, const auto& rightSource, const auto& label)
-    {
-        g.setColour(juce::Colours::teal);
-        g.drawRect(rect);
-        rect.reduce(2,2);
-        
-        g.setColour(juce::Colours::whitesmoke);
-        g.drawText(label, rect.removeFromBottom(fontHeight), juce::Justification::centred);
-        rect.removeFromTop(fontHeight / 2);
-        
-        const auto meterArea = rect;
-        const auto leftChan = rect.removeFromLeft(meterChanWidth);
-        const auto rightChan = rect.removeFromRight(meterChanWidth);
-        
-        fillMeter(leftChan, leftSource);
-        fillMeter(rightChan, rightSource);
-        drawTicks(meterArea, leftChan.getRight(), rightChan.getX());
-    };
-
-    auto bounds = getLocalBounds();
-    bounds.removeFromBottom(ioControlSize);
-    
-    auto preMeterArea = bounds.removeFromLeft(meterWidth);
-    drawMeter(preMeterArea,
-              g,
-              audioProcessor.leftPreRMS,
-              audioProcessor.rightPreRMS,
-              "Input");
-    auto postMeterArea = bounds.removeFromRight(meterWidth);
-    drawMeter(postMeterArea,
-              g,
-              audioProcessor.leftPostRMS, 
-              audioProcessor.rightPostRMS,
-              "Output");
-//
-//    fillMeter(preMeterArea.removeFromLeft(preMeterArea.getWidth() / 2), audioProcessor.leftPreRMS);
-//    fillMeter(preMeterArea, audioProcessor.rightPreRMS);
-//    fillMeter(postMeterArea.removeFromLeft(postMeterArea.getWidth() / 2), audioProcessor.leftPostRMS);
-//    fillMeter(postMeterArea, audioProcessor.rightPostRMS);
-//    
-//    drawTicks(leftMeterArea, leftMeterArea.removeFromLeft(meterChanWidth).getRight(), leftMeterArea.removeFromRight(meterChanWidth).getX());
-//    drawTicks(rightMeterArea, rightMeterArea.removeFromLeft(meterChanWidth).getRight(), rightMeterArea.removeFromRight(meterChanWidth).getX());
-    
-    g.setColour (juce::Colours::white);
-    g.setFont (15.0f);
-    g.drawFittedText ("Morris Sound", getLocalBounds(), juce::Justification::centred, 1);
+        bg.setColour (juce::Colours::white);
+        bg.setFont (15.0f);
+        bg.drawFittedText ("Morris Sound", getLocalBounds(), juce::Justification::centred, 1);
+    });
 }
 
 void VoxProcessorAudioProcessorEditor::resized()
 {
     // This is generally where you'll want to lay out the positions of any
     // subcomponents in your editor..
+    background.invalidate();
+    
+    auto meterBounds = getLocalBounds().withTrimmedBottom(ioControlSize);
+    inputMeterDisplay.setBounds(meterBounds.removeFromLeft(meterWidth));
+    outputMeterDisplay.setBounds(meterBounds.removeFromRight(meterWidth));
+    
     auto bounds = getLocalBounds();
     bounds.removeFromTop(10);
     
@@ -712,7 +1110,14 @@ void VoxProcessorAudioProcessorEditor::resized()
     inGainControl->setBounds(leftMeterArea.removeFromBottom(ioControlSize).reduced(3));
     outGainControl->setBounds(rightMeterArea.removeFromBottom(ioControlSize).reduced(3));
     
+    auto loudnessArea = bounds.removeFromTop(fontHeight);
+    for( auto& box : analyzerTapBoxes )
+        box.setBounds(loudnessArea.removeFromLeft(130).reduced(1));
+    autoGainHoldButton.setBounds(loudnessArea.removeFromRight(60));
+    autoGainButton.setBounds(loudnessArea.removeFromRight(90));
+    loudnessReadout.setBounds(loudnessArea);
     analyzer.setBounds(bounds.removeFromTop(bounds.getHeight() * 0.7));
+    frameStatsOverlay.setBounds(analyzer.getBounds().reduced(4).removeFromLeft(320).removeFromTop(90));
     
     tabbedComponent.setBounds(bounds.removeFromTop(30));
     dspGUI.setBounds(bounds);
@@ -721,7 +1126,11 @@ void VoxProcessorAudioProcessorEditor::resized()
 
 void VoxProcessorAudioProcessorEditor::timerCallback()
 {
-    repaint();
+    //without vblanks (no peer yet, or a platform that doesn't send them) the displays update at the idle rate
+    const auto now = juce::Time::getMillisecondCounterHiRes();
+    if( isShowing() && now - lastVBlankMs >= idleFrameIntervalMs )
+        updateDisplays();
+    
     if(audioProcessor.restoreDspOrderFifo.getNumAvailableForReading() == 0)
         return;
     
@@ -759,10 +1168,59 @@ void VoxProcessorAudioProcessorEditor::timerCallback()
     }
 }
 
+void VoxProcessorAudioProcessorEditor::renderFrame(double timestampMs)
+{
+    frameStats.addFrame(timestampMs);
+    
+    //each display repaints only what moved. Once nothing has for a while, most refreshes are skipped.
+    const auto frameInterval = timestampMs - lastMovedMs < idleAfterMs ? activeFrameIntervalMs : idleFrameIntervalMs;
+    if( timestampMs - lastUpdateMs >= frameInterval )
+    {
+        lastUpdateMs = timestampMs;
+        FrameStats::ScopedTimer timer(&frameStats, FrameStats::Source::Update);
+        if( updateDisplays() )
+            lastMovedMs = timestampMs;
+    }
+    
+    if( frameStatsOverlay.isVisible() )
+        frameStatsOverlay.update(timestampMs);
+}
+
+bool VoxProcessorAudioProcessorEditor::keyPressed(const juce::KeyPress& key)
+{
+    if( key == juce::KeyPress('f', juce::ModifierKeys::commandModifier | juce::ModifierKeys::shiftModifier, 0) )
+    {
+        setFrameStatsVisible(! frameStatsOverlay.isVisible());
+        return true;
+    }
+    
+    return false;
+}
+
+void VoxProcessorAudioProcessorEditor::setFrameStatsVisible(bool shouldBeVisible)
+{
+    frameStats.reset();
+    frameStatsOverlay.setVisible(shouldBeVisible);
+}
+
+bool VoxProcessorAudioProcessorEditor::updateDisplays()
+{
+    auto moved = inputMeterDisplay.update();
+    moved |= outputMeterDisplay.update();
+    moved |= loudnessReadout.update();
+    
+    std::array<bool, SpectrumDisplay::numTraces> tracesShown;
+    tracesShown[0] = audioProcessor.analyzerTapA->getIndex() != static_cast<int>(VoxProcessorAudioProcessor::AnalysisTap::Off);
+    tracesShown[1] = audioProcessor.analyzerTapB->getIndex() != static_cast<int>(VoxProcessorAudioProcessor::AnalysisTap::Off);
+    moved |= analyzer.update(tracesShown);
+    
+    return moved;
+}
+
 void VoxProcessorAudioProcessorEditor::tabbedOrderChanged(VoxProcessorAudioProcessor::DSP_Order newOrder)
 {
     rebuildInterface();
-    audioProcessor.dspOrderFifo.push(newOrder);
+    audioProcessor.setDspOrder(newOrder);
 }
 
 void VoxProcessorAudioProcessorEditor::addTabsFromDSPOrder(VoxProcessorAudioProcessor::DSP_Order newOrder)
@@ -828,7 +1286,7 @@ void VoxProcessorAudioProcessorEditor::addTabsFromDSPOrder(VoxProcessorAudioProc
     }
     tabbedComponent.setTabColours();
     rebuildInterface();
-    audioProcessor.dspOrderFifo.push(newOrder);
+    audioProcessor.setDspOrder(newOrder);
 }
 
 void VoxProcessorAudioProcessorEditor::rebuildInterface()
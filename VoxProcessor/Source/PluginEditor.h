@@ -12,7 +12,6 @@
 #include "PluginProcessor.h"
 #include <LookAndFeel.h>
 #include <CustomButtons.h>
-#include <SpectrumAnalyzer.h>
 
 //==============================================================================
 /**
@@ -159,6 +158,255 @@ private:
     juce::AudioParameterBool* param;
 };
 
+/*
+ A layer that only changes with its component's size: the background, frames, ticks and labels.
+ draw() renders it into an image at the context's physical pixel scale the first time it is needed,
+ then only blits that image until invalidate() is called or the scale changes.
+ */
+struct CachedLayer
+{
+    template<typename RenderFunc>
+    void draw(juce::Graphics& g, juce::Rectangle<int> bounds, RenderFunc&& render)
+    {
+        const auto scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+        const auto width = juce::jmax(1, juce::roundToInt(static_cast<float>(bounds.getWidth()) * scale));
+        const auto height = juce::jmax(1, juce::roundToInt(static_cast<float>(bounds.getHeight()) * scale));
+        if( image.isNull() || image.getWidth() != width || image.getHeight() != height )
+        {
+            image = juce::Image(juce::Image::ARGB, width, height, true);
+            juce::Graphics ig(image);
+            ig.addTransform(juce::AffineTransform::scale(scale));
+            render(ig);
+        }
+        
+        g.drawImage(image, bounds.toFloat());
+    }
+    
+    void invalidate() { image = {}; }
+    
+private:
+    juce::Image image;
+};
+
+/*
+ Frame time instrumentation for the editor's displays: how long each one takes to paint, how long the
+ per frame update takes, and how many display refreshes went by without a frame.
+ A refresh counts as missed when two frames are more than one and a half refresh intervals apart.
+ The interval is learnt from the frames that arrive on time, gaps of a second or more are pauses
+ (the window was hidden) rather than drops. Message thread only.
+ */
+struct FrameStats
+{
+    enum class Source
+    {
+        InputMeter,
+        OutputMeter,
+        Loudness,
+        Analyzer,
+        Update, //pulling the snapshots and building the paths, before anything is painted
+        END_OF_LIST
+    };
+    static constexpr size_t numSources = static_cast<size_t>(Source::END_OF_LIST);
+    
+    struct Times
+    {
+        int count = 0;
+        double lastMs = 0.0, maxMs = 0.0, totalMs = 0.0;
+        
+        double getAverageMs() const noexcept { return count > 0 ? totalMs / count : 0.0; }
+    };
+    
+    //Adds the time from construction to destruction to source. Does nothing without stats.
+    struct ScopedTimer
+    {
+        ScopedTimer(FrameStats* s, Source src) : stats(s), source(src) {}
+        ~ScopedTimer()
+        {
+            if( stats != nullptr )
+                stats->addTime(source, juce::Time::getMillisecondCounterHiRes() - startMs);
+        }
+        
+    private:
+        FrameStats* stats;
+        Source source;
+        double startMs = juce::Time::getMillisecondCounterHiRes();
+    };
+    
+    //once per display refresh, timestampMs from juce::Time::getMillisecondCounterHiRes()
+    void addFrame(double timestampMs);
+    void addTime(Source source, double ms);
+    void reset();
+    
+    const Times& getTimes(Source source) const { return times[static_cast<size_t>(source)]; }
+    int getNumFrames() const noexcept { return numFrames; }
+    int getNumDroppedFrames() const noexcept { return numDroppedFrames; }
+    double getRefreshIntervalMs() const noexcept { return refreshIntervalMs; }
+    
+    static juce::String getName(Source source);
+    
+    //one line per source, for the overlay
+    juce::String toString() const;
+    //the same as JSON, for VoxRender --gui-frame-stats
+    juce::var toVar() const;
+    
+private:
+    std::array<Times, numSources> times;
+    int numFrames = 0, numDroppedFrames = 0;
+    double refreshIntervalMs = 0.0, lastFrameMs = 0.0;
+};
+
+/*
+ A display whose paint() is timed into FrameStats once it has been given some. Subclasses paint in paintDisplay().
+ */
+struct InstrumentedDisplay : juce::Component
+{
+    void setFrameStats(FrameStats* stats, FrameStats::Source source)
+    {
+        frameStats = stats;
+        statsSource = source;
+    }
+    
+    void paint(juce::Graphics& g) final
+    {
+        FrameStats::ScopedTimer timer(frameStats, statsSource);
+        paintDisplay(g);
+    }
+    
+    virtual void paintDisplay(juce::Graphics& g) = 0;
+    
+private:
+    FrameStats* frameStats = nullptr;
+    FrameStats::Source statsSource = FrameStats::Source::END_OF_LIST;
+};
+
+/*
+ FrameStats as text in the top left corner of the editor, for debugging the drawing.
+ It doesn't take the mouse, and its text changes four times a second at most.
+ */
+struct FrameStatsOverlay : juce::Component
+{
+    FrameStatsOverlay(const FrameStats& s);
+    
+    void paint(juce::Graphics& g) override;
+    
+    //message thread, once per frame
+    void update(double timestampMs);
+    
+private:
+    static constexpr double refreshIntervalMs = 250.0;
+    
+    const FrameStats& stats;
+    juce::String text;
+    double lastRefreshMs = 0.0;
+};
+
+/*
+ One of the editor's level meters: a frame, the scale, the label and a bar plus true peak hold line for
+ the first two channels (a mono bus shows its one channel on both).
+ Everything but the bars is a CachedLayer. update() only repaints the rows of a bar whose RMS or hold
+ line moved by at least a pixel, so a steady level costs nothing.
+ */
+struct LevelMeterDisplay : InstrumentedDisplay
+{
+    LevelMeterDisplay(VoxDSP::LevelMeter& m, const juce::String& labelText);
+    
+    void paintDisplay(juce::Graphics& g) override;
+    void resized() override;
+    
+    //message thread, once per frame. Returns true when something was repainted.
+    bool update();
+    
+private:
+    static constexpr int fontHeight = 24;
+    static constexpr int tickIndent = 8;
+    static constexpr int meterChanWidth = 24;
+    static constexpr size_t numBars = 2;
+    
+    //what a bar looks like, in whole pixels
+    struct BarPosition
+    {
+        int rmsY = 0, holdY = 0;
+        bool holdIsOver = false;
+        
+        bool operator==(const BarPosition& other) const noexcept
+        {
+            return rmsY == other.rmsY && holdY == other.holdY && holdIsOver == other.holdIsOver;
+        }
+        bool operator!=(const BarPosition& other) const noexcept { return ! (*this == other); }
+    };
+    
+    VoxDSP::LevelMeter& meter;
+    juce::String label;
+    CachedLayer background;
+    juce::Rectangle<int> meterArea;
+    std::array<juce::Rectangle<int>, numBars> barAreas;
+    std::array<BarPosition, numBars> drawn;
+    
+    int getY(float decibels, const juce::Rectangle<int>& area) const;
+    std::array<BarPosition, numBars> getBarPositions() const;
+    void renderBackground(juce::Graphics& g);
+};
+
+/*
+ The output loudness readout. update() only repaints when the text it shows changes.
+ */
+struct LoudnessReadout : InstrumentedDisplay
+{
+    LoudnessReadout(VoxDSP::LoudnessMeter& m);
+    
+    void paintDisplay(juce::Graphics& g) override;
+    
+    //message thread, once per frame. Returns true when the text changed.
+    bool update();
+    
+private:
+    VoxDSP::LoudnessMeter& meter;
+    juce::String text;
+    
+    static juce::String getText(const VoxDSP::LoudnessMeter::Snapshot& snapshot);
+};
+
+/*
+ Draws what the processor's spectrum analyses publish: a log frequency grid and, for each analyzer trace
+ that is switched on, one path per channel.
+ The FFT and the binning happen on the analyses' worker thread, which runs while the editor holds its
+ AnalysisFeed::Spectrum subscription. update() only turns the newest snapshots into paths.
+ */
+struct SpectrumDisplay : InstrumentedDisplay
+{
+    static constexpr auto numTraces = VoxProcessorAudioProcessor::numAnalyzerTraces;
+    using Analyses = VoxDSP::SpectrumAnalysisBank<numTraces>;
+    
+    SpectrumDisplay(Analyses& a);
+    
+    void paintDisplay(juce::Graphics& g) override;
+    void resized() override;
+    
+    //message thread, once per frame. Only the channels whose points changed are stroked again, and only the
+    //span they moved through is repainted. Showing or hiding a trace repaints it all. Returns true when it repainted.
+    bool update(const std::array<bool, numTraces>& tracesShown);
+    
+private:
+    static constexpr auto maxChannels = VoxDSP::SpectrumAnalysis::maxChannels;
+    using Points = std::array<float, VoxDSP::SpectrumAnalysis::numPoints>;
+    
+    Analyses& analyses;
+    CachedLayer grid;
+    juce::Path line;
+    
+    //what is on screen: the points, and their line already stroked, so paint() only fills
+    std::array<std::array<Points, maxChannels>, numTraces> drawnPoints {};
+    std::array<std::array<juce::Path, maxChannels>, numTraces> strokes;
+    std::array<size_t, numTraces> drawnNumChannels {};
+    std::array<bool, numTraces> shown {};
+    
+    void renderGrid(juce::Graphics& g);
+    void buildStroke(size_t trace, size_t channel);
+    
+    //the area two sets of points differ in, empty when they are the same
+    juce::Rectangle<int> getChangedArea(const Points& before, const Points& after) const;
+};
+
 struct RotarySliderWithLabels; //Forward declaration
 struct DSP_Gui : juce::Component
 {
@@ -198,37 +446,74 @@ public:
     void selectedTabChanged(int newCurrentTabIndex) override;
 
     void timerCallback() override;
+    
+    //Cmd/Ctrl+Shift+F shows and hides the frame stats
+    bool keyPressed(const juce::KeyPress& key) override;
+    
+    //What the vblank callback does once per display refresh, timestampMs from juce::Time::getMillisecondCounterHiRes().
+    //VoxRender --gui-frame-stats calls it to drive the editor offscreen, where there is no vblank.
+    void renderFrame(double timestampMs);
+    
+    const FrameStats& getFrameStats() const noexcept { return frameStats; }
+    void setFrameStatsVisible(bool shouldBeVisible);
 private:
     // This reference is provided as a quick way for your editor to
     // access the processor object that created it.
     VoxProcessorAudioProcessor& audioProcessor;
+    
+    //the processor only meters and analyses while the editor is open
+    std::array<VoxProcessorAudioProcessor::AnalysisSubscription, 3> analysisSubscriptions
+    {
+        audioProcessor.subscribe(VoxProcessorAudioProcessor::AnalysisFeed::LevelMeters),
+        audioProcessor.subscribe(VoxProcessorAudioProcessor::AnalysisFeed::Loudness),
+        audioProcessor.subscribe(VoxProcessorAudioProcessor::AnalysisFeed::Spectrum),
+    };
+    
     LookAndFeel lookAndFeel;
     DSP_Gui dspGUI { audioProcessor };
     
     ExtendedTabbedButtonBar tabbedComponent;
     
-    SimpleMBComp::SpectrumAnalyzer analyzer {
-        audioProcessor,
-        audioProcessor.leftSCSF,
-        audioProcessor.rightSCSF
-    };
+    SpectrumDisplay analyzer { audioProcessor.spectrumAnalyses };
+    LevelMeterDisplay inputMeterDisplay { audioProcessor.inputMeter, "Input" };
+    LevelMeterDisplay outputMeterDisplay { audioProcessor.outputMeter, "Output" };
+    LoudnessReadout loudnessReadout { audioProcessor.outputLoudness };
+    
+    //the background and the logo, the children draw everything that moves
+    CachedLayer background;
+    
+    FrameStats frameStats;
+    FrameStatsOverlay frameStatsOverlay { frameStats };
+    
+    //Every refresh (60fps at most) while anything moves, 10fps once it has all been still for half a second.
+    //The timer only stands in when no vblank arrives.
+    static constexpr double activeFrameIntervalMs = 15.0;
+    static constexpr int idleFrameIntervalMs = 100;
+    static constexpr double idleAfterMs = 500.0;
+    double lastUpdateMs = 0.0, lastMovedMs = 0.0, lastVBlankMs = 0.0;
+    
+    //where the two analyzer traces listen
+    std::array<juce::ComboBox, SpectrumDisplay::numTraces> analyzerTapBoxes;
+    std::array<std::unique_ptr<juce::ComboBoxParameterAttachment>, SpectrumDisplay::numTraces> analyzerTapAttachments;
     
     static constexpr int meterWidth = 80;
     static constexpr int fontHeight = 24;
-    static constexpr int tickIndent = 8;
-    static constexpr int meterChanWidth = 24;
     static constexpr int ioControlSize = 100;
     
     std::unique_ptr<RotarySliderWithLabels> inGainControl, outGainControl;
     std::unique_ptr<juce::SliderParameterAttachment> inGainAttachment, outGainAttachment;
+    
+    juce::ToggleButton autoGainButton { "Auto Gain" }, autoGainHoldButton { "Hold" };
+    std::unique_ptr<juce::ButtonParameterAttachment> autoGainAttachment, autoGainHoldAttachment;
     std::unique_ptr<juce::ParameterAttachment> selectedTabAttachment;
     
     void addTabsFromDSPOrder(VoxProcessorAudioProcessor::DSP_Order);
     void rebuildInterface();
     void refreshDSPGUIControlEnablement(PowerButtonWithParam* button);
-    
-    static constexpr int NEGATIVE_INFINITY = -72;
-    static constexpr int MAX_DECIBELS = 12;
+    bool updateDisplays();
+
+    //last, so it stops before anything it draws goes away
+    juce::VBlankAttachment vblankAttachment { this, [this] { lastVBlankMs = juce::Time::getMillisecondCounterHiRes(); renderFrame(lastVBlankMs); } };
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (VoxProcessorAudioProcessorEditor)
 };
@@ -24,7 +24,11 @@ auto getChorusFeedbackName() { return juce::String("Chorus Feedback %" ); }
 auto getChorusMixName() { return juce::String("Chorus Mix %"); }
 
 auto getOverdriveSaturationName() { return juce::String("Overdrive Saturation"); }
+auto getOverdriveCurveName() { return juce::String("Overdrive Curve"); }
+auto getOverdriveAntialiasingName() { return juce::String("Overdrive Antialiasing"); }
+auto getOverdriveOversamplingName() { return juce::String("Overdrive Oversampling"); }
 auto getLadderFilterModeName() { return juce::String("Ladder Filter Mode"); }
+auto getLadderFilterOversamplingName() { return juce::String("Ladder Filter Oversampling"); }
 auto getLadderFilterCutoffName() { return juce::String("Ladder Filter Cuttoff"); }
 auto getLadderFilterResonanceName() { return juce::String("Ladder Filter Resonance"); }
 auto getLadderFilterDriveName() { return juce::String("Ladder Filter Drive"); }
@@ -42,6 +46,15 @@ auto getLadderFilterChoices()
     };
 }
 
+auto getOverdriveAntialiasingChoices()
+{
+    return juce::StringArray
+    {
+        "Off",
+        "ADAA",
+    };
+}
+
 auto getGenearlFilterChoices()
 {
     return juce::StringArray
@@ -67,6 +80,31 @@ auto getGeneralFilterBypassName() { return juce::String("General Filter Bypass")
 auto getInputGainName() { return juce::String("Input Gain dB"); }
 auto getOutputGainName() { return juce::String("Output Gain dB"); }
 
+auto getAutoGainName() { return juce::String("Auto Gain"); }
+auto getAutoGainHoldName() { return juce::String("Auto Gain Hold"); }
+auto getAutoGainWindowName() { return juce::String("Auto Gain Window ms"); }
+auto getAutoGainAttackName() { return juce::String("Auto Gain Attack ms"); }
+auto getAutoGainReleaseName() { return juce::String("Auto Gain Release ms"); }
+
+auto getAnalyzerTapAName() { return juce::String("Analyzer Tap A"); }
+auto getAnalyzerTapBName() { return juce::String("Analyzer Tap B"); }
+
+//in the order of AnalysisTap
+auto getAnalyzerTapChoices()
+{
+    return juce::StringArray
+    {
+        "After Phaser",
+        "After Chorus",
+        "After Overdrive",
+        "After Ladder Filter",
+        "After General Filter",
+        "Input",
+        "Output",
+        "Off",
+    };
+}
+
 
 //==============================================================================
 VoxProcessorAudioProcessor::VoxProcessorAudioProcessor()
@@ -95,6 +133,7 @@ VoxProcessorAudioProcessor::VoxProcessorAudioProcessor()
     {
         dspOrder[i] = static_cast<DSP_Option>(i);
     }
+    publishedDspOrder = dspOrder;
     restoreDspOrderFifo.push(dspOrder);
     
     auto floatParams = std::array
@@ -123,6 +162,10 @@ VoxProcessorAudioProcessor::VoxProcessorAudioProcessor()
         
         &inputGain,
         &outputGain,
+        
+        &autoGainWindowMs,
+        &autoGainAttackMs,
+        &autoGainReleaseMs,
     };
     
     auto floatNameFuncs = std::array
@@ -151,6 +194,10 @@ VoxProcessorAudioProcessor::VoxProcessorAudioProcessor()
         
         &getInputGainName,
         &getOutputGainName,
+        
+        &getAutoGainWindowName,
+        &getAutoGainAttackName,
+        &getAutoGainReleaseName,
     };
     
     
@@ -158,16 +205,32 @@ VoxProcessorAudioProcessor::VoxProcessorAudioProcessor()
     
     auto choiceParams = std::array
     {
+        &overdriveCurve,
+        &overdriveAntialiasing,
+        &overdriveOversampling,
+        
         &ladderFilterMode,
+        &ladderFilterOversampling,
         
         &generalFilterMode,
+        
+        &analyzerTapA,
+        &analyzerTapB,
     };
     
     auto choiceFuncs = std::array
     {
+        &getOverdriveCurveName,
+        &getOverdriveAntialiasingName,
+        &getOverdriveOversamplingName,
+        
         &getLadderFilterModeName,
+        &getLadderFilterOversamplingName,
         
         &getGeneralFilterModeName,
+        
+        &getAnalyzerTapAName,
+        &getAnalyzerTapBName,
     };
     
     
@@ -193,6 +256,20 @@ VoxProcessorAudioProcessor::VoxProcessorAudioProcessor()
     
     initCachedParams<juce::AudioParameterBool*>(bypassParams, bypassNameFuncs);
     
+    auto autoGainParams = std::array
+    {
+        &autoGain,
+        &autoGainHold,
+    };
+    
+    auto autoGainNameFuncs = std::array
+    {
+        &getAutoGainName,
+        &getAutoGainHoldName,
+    };
+    
+    initCachedParams<juce::AudioParameterBool*>(autoGainParams, autoGainNameFuncs);
+    
     auto intParams = std::array
     {
         &selectedTab,
@@ -204,10 +281,54 @@ VoxProcessorAudioProcessor::VoxProcessorAudioProcessor()
     };
     
     initCachedParams<juce::AudioParameterInt*>(intParams, intFuncs);
+    
+    //in the order of SmoothedParam
+    smoothedParams =
+    {
+        phaserRateHz,
+        phaserCenterFreqHz,
+        phaserDepthPercent,
+        phaserFeedbackPercent,
+        phaserMixPercent,
+        chorusRateHz,
+        chorusDepthPercent,
+        chorusCenterDelayMs,
+        chorusFeedbackPercent,
+        chorusMixPercent,
+        overdriveSaturation,
+        ladderFilterCutoffHz,
+        ladderFilterResonance,
+        ladderFilterDrive,
+        generalFilterFreqHz,
+        generalFilterQuality,
+        generalFilterGain,
+    };
+    
+   #if VOX_CLAP_DIRECT_EVENTS
+    for( auto* p : getParameters() )
+    {
+        auto* withId = dynamic_cast<juce::AudioProcessorParameterWithID*>(p);
+        if( withId == nullptr )
+            continue;
+        
+        DirectEventParameter entry;
+        entry.id = static_cast<clap_id>(withId->paramID.hashCode());
+        entry.param = p;
+        auto smoothed = std::find(smoothedParams.begin(), smoothedParams.end(), p);
+        if( smoothed != smoothedParams.end() )
+            entry.smoothedIndex = static_cast<int>(std::distance(smoothedParams.begin(), smoothed));
+        
+        directEventParams.push_back(entry);
+    }
+    
+    std::sort(directEventParams.begin(), directEventParams.end(), [](const auto& a, const auto& b) { return a.id < b.id; });
+    changedDirectEventParams.reserve(directEventParams.size());
+   #endif
 }
 
 VoxProcessorAudioProcessor::~VoxProcessorAudioProcessor()
 {
+    cancelPendingUpdate();
 }
 
 //==============================================================================
@@ -245,7 +366,7 @@ bool VoxProcessorAudioProcessor::isMidiEffect() const
 
 double VoxProcessorAudioProcessor::getTailLengthSeconds() const
 {
-    return 0.0;
+    return static_cast<double>(tailLengthSeconds.get());
 }
 
 int VoxProcessorAudioProcessor::getNumPrograms()
@@ -274,231 +395,697 @@ void VoxProcessorAudioProcessor::changeProgramName (int index, const juce::Strin
 
 
 
-void VoxProcessorAudioProcessor::MonoChannelDSP::prepare(const juce::dsp::ProcessSpec& spec)
+void VoxProcessorAudioProcessor::ChainEngine::prepare(const juce::dsp::ProcessSpec& spec, OversamplingMode overdriveMode, OversamplingMode ladderFilterMode)
 {
-    jassert(spec.numChannels == 1);
+    hostSpec = spec;
     
     std::vector<juce::dsp::ProcessorBase*> dsp
     {
         &phaser,
         &chorus,
-        &overdrive,
-        &ladderFilter,
         &generalFilter,
     };
     
     for (auto p : dsp)
     {
         p->prepare(spec);
-        p->reset();
     }
+    
+    //only the selected modes are built, a later change is built on the message thread
+    overdriveOversampler.prepare(spec, overdriveMode);
+    ladderFilterOversampler.prepare(spec, ladderFilterMode);
+    overdrive.prepare(getOversampledSpec(overdriveOversampler));
+    ladderFilter.prepare(getOversampledSpec(ladderFilterOversampler));
+    
+    reset();
+}
+
+juce::dsp::ProcessSpec VoxProcessorAudioProcessor::ChainEngine::getOversampledSpec(const VoxDSP::StageOversampling& oversampler) const noexcept
+{
+    auto spec = hostSpec;
+    spec.sampleRate *= static_cast<double>(oversampler.getFactor());
+    spec.maximumBlockSize *= static_cast<juce::uint32>(oversampler.getFactor());
+    return spec;
 }
 
-void VoxProcessorAudioProcessor::MonoChannelDSP::updateDSPFromParams()
+VoxDSP::StageOversampling* VoxProcessorAudioProcessor::ChainEngine::getOversampler(DSP_Option option) noexcept
 {
+    switch (option)
+    {
+        case DSP_Option::OverDrive:     return &overdriveOversampler;
+        case DSP_Option::LadderFilter:  return &ladderFilterOversampler;
+        default:                        break;
+    }
+    return nullptr;
+}
+
+bool VoxProcessorAudioProcessor::ChainEngine::prepareOversampling(OversamplingMode overdriveMode, OversamplingMode ladderFilterMode)
+{
+    auto prepared = overdriveOversampler.prepareMode(overdriveMode);
+    prepared |= ladderFilterOversampler.prepareMode(ladderFilterMode);
+    return prepared;
+}
+
+bool VoxProcessorAudioProcessor::ChainEngine::switchOversampling()
+{
+    //the stages are prepared again for their new rate. Their state vectors keep their size, so this doesn't allocate.
+    bool changed = false;
+    if( overdriveOversampler.switchToPreparedMode() )
+    {
+        overdrive.prepare(getOversampledSpec(overdriveOversampler));
+        changed = true;
+    }
     
-    phaser.dsp.setRate(p.phaserRateHzSmoother.getCurrentValue());
-    phaser.dsp.setCentreFrequency(p.phaserCenterFreqHzSmoother.getCurrentValue());
-    phaser.dsp.setDepth(p.phaserDepthPercentSmoother.getCurrentValue() * 0.01f);
-    phaser.dsp.setFeedback(p.phaserFeedbackPercentSmoother.getCurrentValue() * 0.01f);
-    phaser.dsp.setMix(p.phaserMixPercentSmoother.getCurrentValue() * 0.01f);
+    if( ladderFilterOversampler.switchToPreparedMode() )
+    {
+        ladderFilter.prepare(getOversampledSpec(ladderFilterOversampler));
+        changed = true;
+    }
     
-    chorus.dsp.setRate(p.chorusRateHzSmoother.getCurrentValue());
-    chorus.dsp.setDepth(p.chorusDepthPercentSmoother.getCurrentValue() * 0.01f);
-    chorus.dsp.setCentreDelay(p.chorusCenterDelayMsSmoother.getCurrentValue());
-    chorus.dsp.setFeedback(p.chorusFeedbackPercentSmoother.getCurrentValue() * 0.01f);
-    chorus.dsp.setMix(p.chorusMixPercentSmoother.getCurrentValue() * 0.01f);
+    return changed;
+}
+
+int VoxProcessorAudioProcessor::ChainEngine::getLatencyInSamples() const noexcept
+{
+    //bypassed stages are delayed by the same amount, see compilePlan()
+    return overdriveOversampler.getLatencyInSamples() + ladderFilterOversampler.getLatencyInSamples();
+}
+
+void VoxProcessorAudioProcessor::ChainEngine::reset()
+{
+    phaser.reset();
+    chorus.reset();
+    overdrive.reset();
+    ladderFilter.reset();
+    generalFilter.reset();
+    overdriveOversampler.reset();
+    ladderFilterOversampler.reset();
+    idleStates.fill({});
+}
+
+namespace
+{
+    //time for a loop with this gain, going round once every loopSeconds, to decay by 60dB
+    double getDecaySeconds(double loopGain, double loopSeconds)
+    {
+        loopGain = std::abs(loopGain);
+        if( loopGain < 1.0e-3 )
+            return loopSeconds;
+        
+        return loopSeconds * 3.0 / -std::log10(juce::jmin(loopGain, 0.999));
+    }
     
-    overdrive.dsp.setDrive(p.overdriveSaturationSmoother.getCurrentValue());
-    overdrive.dsp.setCutoffFrequencyHz(20000.f);
+    //60dB decay of a resonance at freqHz with this Q
+    double getResonanceDecaySeconds(double freqHz, double q)
+    {
+        return 6.91 * q / (juce::MathConstants<double>::pi * juce::jmax(freqHz, 1.0));
+    }
     
-    ladderFilter.dsp.setMode(static_cast<juce::dsp::LadderFilterMode>(p.ladderFilterMode->getIndex()));
-    ladderFilter.dsp.setCutoffFrequencyHz(p.ladderFilterCutoffHzSmoother.getCurrentValue());
-    ladderFilter.dsp.setResonance(p.ladderFilterResonanceSmoother.getCurrentValue() * 0.01f);
-    ladderFilter.dsp.setDrive(p.ladderFilterDriveSmoother.getCurrentValue());
+    //no single stage or chain reports more than this
+    constexpr double maxTailSeconds = 10.0;
+}
+
+double VoxProcessorAudioProcessor::ChainEngine::getTailLengthSeconds() const noexcept
+{
+    //the stages are in series, their tails add up
+    double seconds = 0.0;
+    for( size_t i = 0; i < plan.numStages; ++i )
+    {
+        const auto option = plan.stages[i].option;
+        if( plan.bypassMask & (1u << static_cast<juce::uint32>(option)) )
+            continue; //only a delay, counted in the latency
+        
+        seconds += getStageDecaySeconds(option);
+    }
     
+    return juce::jmin(seconds, maxTailSeconds);
+}
+
+double VoxProcessorAudioProcessor::ChainEngine::getStageDecaySeconds(DSP_Option option) const noexcept
+{
+    //estimates on the safe side, not measurements
+    switch (option)
+    {
+        case DSP_Option::Phase:
+        {
+            //6 first order allpass stages in the feedback loop, about 1 / (2pi * fc) of delay each
+            auto loopSeconds = 6.0 / (juce::MathConstants<double>::twoPi * p.phaserCenterFreqHz->get());
+            return loopSeconds + getDecaySeconds(p.phaserFeedbackPercent->get() * 0.01, loopSeconds);
+        }
+        case DSP_Option::Chorus:
+        {
+            //the delay line plus the modulation depth, repeated by the feedback
+            auto delaySeconds = (p.chorusCenterDelayMs->get() + 20.0) * 0.001;
+            return delaySeconds + getDecaySeconds(p.chorusFeedbackPercent->get() * 0.01, delaySeconds);
+        }
+        case DSP_Option::OverDrive:
+        {
+            //memoryless, apart from the 10Hz DC blocker after the tube curve
+            if( static_cast<OverdriveCurve>(p.overdriveCurve->getIndex()) == OverdriveCurve::AsymmetricTube )
+                return getResonanceDecaySeconds(10.0, 0.5);
+            break;
+        }
+        case DSP_Option::LadderFilter:
+        {
+            //the Q climbs steeply towards full resonance, where the ladder is close to self oscillation
+            auto resonance = p.ladderFilterResonance->get() * 0.01;
+            return getResonanceDecaySeconds(p.ladderFilterCutoffHz->get(), 0.707 / (1.0 - 0.95 * resonance));
+        }
+        case DSP_Option::GeneralFilter:
+            return getResonanceDecaySeconds(p.generalFilterFreqHz->get(), p.generalFilterQuality->get());
+        case DSP_Option::END_OF_LIST:
+            break;
+    }
     
-    auto sampleRate = p.getSampleRate();
-    //update generalFilter coefficients
-    //choices: peak, bandpass, notch, allpass
-    auto genMode = p.generalFilterMode->getIndex();
-    auto genHz = p.generalFilterFreqHzSmoother.getCurrentValue();
-    auto genQ = p.generalFilterQualitySmoother.getCurrentValue();
-    auto genGain = p.generalFilterGainSmoother.getCurrentValue();
+    return 0.0;
+}
+
+int VoxProcessorAudioProcessor::ChainEngine::getStageMemoryInSamples(DSP_Option option) const noexcept
+{
+    //how long an input can still show up at the output: the oversampling filters, then the stage's own decay.
+    //A resonance can ring on below the silence threshold for a while and come back above it,
+    //so a filter only sleeps once its ring has had time to die away.
+    auto latency = 0;
+    if( option == DSP_Option::OverDrive )
+        latency = overdriveOversampler.getLatencyInSamples();
+    else if( option == DSP_Option::LadderFilter )
+        latency = ladderFilterOversampler.getLatencyInSamples();
+    
+    const auto decaySeconds = juce::jmin(getStageDecaySeconds(option), maxTailSeconds);
+    return latency + juce::roundToInt(decaySeconds * hostSpec.sampleRate);
+}
+
+bool VoxProcessorAudioProcessor::ChainEngine::isStageRunning(DSP_Option option) const noexcept
+{
+    const auto index = static_cast<size_t>(option);
+    return (plan.bypassMask & (1u << index)) == 0 && ! idleStates[index].asleep;
+}
+
+void VoxProcessorAudioProcessor::ChainEngine::resetStage(DSP_Option option)
+{
+    idleStates[static_cast<size_t>(option)] = {};
     
-    bool filterChanged = false;
-    filterChanged |= (filterFreq != genHz);
-    filterChanged |= (filterQ != genQ);
-    filterChanged |= (filterGain != genGain);
+    switch (option)
+    {
+        case DSP_Option::Phase:
+            phaser.reset();
+            break;
+        case DSP_Option::Chorus:
+            chorus.reset();
+            break;
+        case DSP_Option::OverDrive:
+            overdrive.reset();
+            overdriveOversampler.reset();
+            break;
+        case DSP_Option::LadderFilter:
+            ladderFilter.reset();
+            ladderFilterOversampler.reset();
+            updateLadderFilter(); //the reset snaps the coefficients to these on the next block
+            break;
+        case DSP_Option::GeneralFilter:
+            generalFilter.reset();
+            updateGeneralFilter();
+            break;
+        case DSP_Option::END_OF_LIST:
+            jassertfalse;
+            break;
+    }
+}
+
+VoxProcessorAudioProcessor::StageFunction VoxProcessorAudioProcessor::ChainEngine::getStageFunction(DSP_Option option)
+{
+    switch (option)
+    {
+        case DSP_Option::Phase:         return &processPhaser;
+        case DSP_Option::Chorus:        return &processChorus;
+        case DSP_Option::OverDrive:     return &processOverdrive;
+        case DSP_Option::LadderFilter:  return &processLadderFilter;
+        case DSP_Option::GeneralFilter: return &processGeneralFilter;
+        case DSP_Option::END_OF_LIST:   break;
+    }
     
-    auto updatedMode = static_cast<GeneralFilterMode>(genMode);
-    filterChanged |= (filterMode != updatedMode);
+    jassertfalse;
+    return nullptr;
+}
+
+VoxProcessorAudioProcessor::StageFunction VoxProcessorAudioProcessor::ChainEngine::getBypassedStageFunction(DSP_Option option)
+{
+    switch (option)
+    {
+        case DSP_Option::OverDrive:     return &delayOverdrive;
+        case DSP_Option::LadderFilter:  return &delayLadderFilter;
+        default:                        break;
+    }
     
-    if(filterChanged)
+    jassertfalse;
+    return nullptr;
+}
+
+void VoxProcessorAudioProcessor::ChainEngine::processPhaser(ChainEngine& c,
+                                                            juce::dsp::AudioBlock<float> block,
+                                                            const ControlFrame* frames,
+                                                            size_t numFrames)
+{
+    auto& phaser = c.phaser.dsp;
+    for( size_t f = 0; f < numFrames; ++f )
     {
+        const auto& frame = frames[f];
+        phaser.setRate(frame.phaserRateHz);
+        phaser.setCentreFrequency(frame.phaserCenterFreqHz);
+        phaser.setDepth(frame.phaserDepth);
+        phaser.setFeedback(frame.phaserFeedback);
+        phaser.setMix(frame.phaserMix);
         
-        filterMode = updatedMode;
-        filterQ = genQ;
-        filterFreq = genHz;
-        filterGain = genGain;
+        auto subBlock = block.getSubBlock(frame.startSample, frame.numSamples);
+        phaser.process(juce::dsp::ProcessContextReplacing<float>(subBlock));
+    }
+}
+
+void VoxProcessorAudioProcessor::ChainEngine::processChorus(ChainEngine& c,
+                                                            juce::dsp::AudioBlock<float> block,
+                                                            const ControlFrame* frames,
+                                                            size_t numFrames)
+{
+    auto& chorus = c.chorus.dsp;
+    for( size_t f = 0; f < numFrames; ++f )
+    {
+        const auto& frame = frames[f];
+        chorus.setRate(frame.chorusRateHz);
+        chorus.setDepth(frame.chorusDepth);
+        chorus.setCentreDelay(frame.chorusCenterDelayMs);
+        chorus.setFeedback(frame.chorusFeedback);
+        chorus.setMix(frame.chorusMix);
         
-        juce::dsp::IIR::Coefficients<float>::Ptr coefficients;
-        switch (filterMode)
+        auto subBlock = block.getSubBlock(frame.startSample, frame.numSamples);
+        chorus.process(juce::dsp::ProcessContextReplacing<float>(subBlock));
+    }
+}
+
+void VoxProcessorAudioProcessor::ChainEngine::processOverdrive(ChainEngine& c,
+                                                               juce::dsp::AudioBlock<float> block,
+                                                               const ControlFrame* frames,
+                                                               size_t numFrames)
+{
+    auto& overdrive = c.overdrive.dsp;
+    overdrive.setCurve(static_cast<OverdriveCurve>(c.p.overdriveCurve->getIndex()));
+    overdrive.setAntiderivativeAntialiasing(c.p.overdriveAntialiasing->getIndex() == 1);
+    
+    const auto factor = c.overdriveOversampler.getFactor();
+    c.overdriveOversampler.process(block, [&](juce::dsp::AudioBlock<float> oversampled)
+    {
+        //the control frames are in host samples
+        for( size_t f = 0; f < numFrames; ++f )
         {
-            case GeneralFilterMode::Peak:
-            {
-                coefficients = juce::dsp::IIR::Coefficients<float>::makePeakFilter(sampleRate,
-                                                                                   filterFreq,
-                                                                                   filterQ,
-                                                                                   juce::Decibels::decibelsToGain(filterGain));
-                break;
-            }
-            case GeneralFilterMode::Bandpass:
-            {
-                coefficients = juce::dsp::IIR::Coefficients<float>::makeBandPass(sampleRate,
-                                                                                 filterFreq,
-                                                                                 filterQ);
-                break;
-            }
-            case GeneralFilterMode::Notch:
-            {
-                coefficients = juce::dsp::IIR::Coefficients<float>::makeNotch(sampleRate,
-                                                                              filterFreq,
-                                                                              filterQ);
-                break;
-            }
-            case GeneralFilterMode::Allpass:
-            {
-                coefficients = juce::dsp::IIR::Coefficients<float>::makeAllPass(sampleRate,
-                                                                                filterFreq,
-                                                                                filterQ);
-                break;
-            }
-            case GeneralFilterMode::END_OF_LIST:
+            const auto& frame = frames[f];
+            overdrive.setDrive(frame.overdriveSaturation);
+            
+            auto subBlock = oversampled.getSubBlock(frame.startSample * factor, frame.numSamples * factor);
+            overdrive.process(juce::dsp::ProcessContextReplacing<float>(subBlock));
+        }
+    });
+}
+
+void VoxProcessorAudioProcessor::ChainEngine::processLadderFilter(ChainEngine& c,
+                                                                  juce::dsp::AudioBlock<float> block,
+                                                                  const ControlFrame*,
+                                                                  size_t)
+{
+    //targets were set in updateRampedStages()
+    c.ladderFilterOversampler.process(block, [&c](juce::dsp::AudioBlock<float> oversampled)
+    {
+        c.ladderFilter.dsp.process(juce::dsp::ProcessContextReplacing<float>(oversampled));
+    });
+}
+
+void VoxProcessorAudioProcessor::ChainEngine::processGeneralFilter(ChainEngine& c,
+                                                                   juce::dsp::AudioBlock<float> block,
+                                                                   const ControlFrame*,
+                                                                   size_t)
+{
+    c.generalFilter.dsp.process(juce::dsp::ProcessContextReplacing<float>(block));
+}
+
+void VoxProcessorAudioProcessor::ChainEngine::delayOverdrive(ChainEngine& c,
+                                                             juce::dsp::AudioBlock<float> block,
+                                                             const ControlFrame*,
+                                                             size_t)
+{
+    c.overdriveOversampler.processBypassed(block);
+}
+
+void VoxProcessorAudioProcessor::ChainEngine::delayLadderFilter(ChainEngine& c,
+                                                                juce::dsp::AudioBlock<float> block,
+                                                                const ControlFrame*,
+                                                                size_t)
+{
+    c.ladderFilterOversampler.processBypassed(block);
+}
+
+void VoxProcessorAudioProcessor::ChainEngine::updateRampedStages()
+{
+    //the smoothers have been advanced to the end of the block.
+    //the filters ramp from where they are now to these values over the whole block.
+    //stages that are bypassed or asleep are skipped, resetStage() catches them up when they come back.
+    if( isStageRunning(DSP_Option::LadderFilter) )
+        updateLadderFilter();
+    
+    if( isStageRunning(DSP_Option::GeneralFilter) )
+        updateGeneralFilter();
+}
+
+void VoxProcessorAudioProcessor::ChainEngine::updateLadderFilter()
+{
+    //the ladder may be oversampled, so it turns the cutoff into its coefficient itself
+    const auto& params = p.rampedStageParams;
+    ladderFilter.dsp.setRampInterval(params.rampInterval);
+    ladderFilter.dsp.setMode(params.ladderFilterMode);
+    ladderFilter.dsp.setCutoffFrequencyHz(params.ladderFilterCutoffHz);
+    ladderFilter.dsp.setResonance(params.ladderFilterResonance);
+    ladderFilter.dsp.setDrive(params.ladderFilterDrive);
+}
+
+void VoxProcessorAudioProcessor::ChainEngine::updateGeneralFilter()
+{
+    //no reset() so sweeps don't click, the filter interpolates g/k towards the new coefficients across the block.
+    const auto& params = p.rampedStageParams;
+    generalFilter.dsp.setRampInterval(params.rampInterval);
+    generalFilter.dsp.setCoefficients(params.generalFilterCoefficients);
+}
+
+void VoxProcessorAudioProcessor::updateRampedStageParameters(bool redesign)
+{
+    auto& params = rampedStageParams;
+    params.rampInterval = coefficientRampInterval.get();
+    
+    params.ladderFilterMode = static_cast<juce::dsp::LadderFilterMode>(ladderFilterMode->getIndex());
+    params.ladderFilterCutoffHz = getSmoothedValue(SmoothedParam::LadderFilterCutoffHz);
+    params.ladderFilterResonance = getSmoothedValue(SmoothedParam::LadderFilterResonance) * 0.01f;
+    params.ladderFilterDrive = getSmoothedValue(SmoothedParam::LadderFilterDrive);
+    
+    //choices: peak, bandpass, notch, allpass
+    auto genMode = static_cast<GeneralFilterMode>(generalFilterMode->getIndex());
+    auto genHz = getSmoothedValue(SmoothedParam::GeneralFilterFreqHz);
+    auto genQ = getSmoothedValue(SmoothedParam::GeneralFilterQuality);
+    auto genGain = getSmoothedValue(SmoothedParam::GeneralFilterGain);
+    
+    bool filterChanged = redesign;
+    filterChanged |= (params.generalFilterMode != genMode);
+    filterChanged |= (params.generalFilterFreqHz != genHz);
+    filterChanged |= (params.generalFilterQuality != genQ);
+    filterChanged |= (params.generalFilterGain != genGain);
+    
+    if( filterChanged )
+    {
+        params.generalFilterMode = genMode;
+        params.generalFilterFreqHz = genHz;
+        params.generalFilterQuality = genQ;
+        params.generalFilterGain = genGain;
+        params.generalFilterCoefficients = VoxDSP::GeneralFilter::design(genMode, getSampleRate(), genHz, genQ, genGain);
+    }
+}
+
+void VoxProcessorAudioProcessor::updateSmoothersFromParams(int numSamplesToSkip, SmootherUpdateMode init)
+{
+    for(size_t i = 0; i < smoothedParams.size(); ++i)
+    {
+        if (init == SmootherUpdateMode::initialize) {
+            automationTargets[i] = smoothedParams[i]->get();
+            parameterSmoothers.setCurrentAndTargetValue(i, automationTargets[i]);
+        }else{
+            parameterSmoothers.setTargetValue(i, automationTargets[i]);
+        }
+    }
+    
+    parameterSmoothers.skip(numSamplesToSkip);
+}
+
+void VoxProcessorAudioProcessor::ChainEngine::process(juce::dsp::AudioBlock<float> block,
+                                                      const ControlFrame* frames,
+                                                      size_t numFrames,
+                                                      bool inputIsSilent,
+                                                      bool feedsAnalyzer)
+{
+    //the selected stage taps go to their trace's analysis ring as soon as their stage is done with the block
+    auto pushTaps = [&](int stageIndex)
+    {
+        if( ! feedsAnalyzer )
+            return;
+        
+        for( size_t t = 0; t < numAnalyzerTraces; ++t )
+        {
+            const auto tap = p.analyzerTaps[t];
+            if( tap < AnalysisTap::Input && plan.tapAfterStage[static_cast<size_t>(tap)] == stageIndex )
+                p.spectrumAnalyses.push(t, block);
+        }
+    };
+    
+    pushTaps(-1);
+    
+    //Each stage runs over the whole block before the next one starts.
+    //Bypassed stages aren't in the plan at all, or only as a delay, see compilePlan().
+    const auto numSamples = static_cast<int>(block.getNumSamples());
+    for(size_t i = 0; i < plan.numStages; ++i)
+    {
+        const auto& stage = plan.stages[i];
+        auto& idle = idleStates[static_cast<size_t>(stage.option)];
+        
+        if( idle.asleep )
+        {
+            if( inputIsSilent )
             {
-                jassertfalse;
-                break;
+                pushTaps(static_cast<int>(i));
+                continue;
             }
+            
+            resetStage(stage.option);
         }
         
-        if (coefficients != nullptr)
         {
-//            if (generalFilter.dsp.coefficients->coefficients.size() != coefficients->coefficients.size())
-//            {
-//                jassertfalse;
-//            }
-//            
-            *generalFilter.dsp.coefficients = *coefficients;
-            generalFilter.reset();
+            static_assert(static_cast<int>(DSP_Option::GeneralFilter) == static_cast<int>(ProfiledStage::GeneralFilter));
+            VOX_PROFILE_STAGE(p.stageTicks, static_cast<ProfiledStage>(stage.option));
+            
+            stage.process(*this, block, frames, numFrames);
         }
+        
+        //the output is only looked at while the input is silent, i.e. while the stage rings out
+        auto outputIsQuiet = false;
+        if( inputIsSilent )
+        {
+            auto range = block.findMinAndMax();
+            outputIsQuiet = range.getStart() > -silenceThreshold && range.getEnd() < silenceThreshold;
+        }
+        
+        if( outputIsQuiet )
+        {
+            idle.quietSamples += numSamples;
+            idle.asleep = idle.quietSamples > getStageMemoryInSamples(stage.option);
+        }
+        else
+        {
+            idle.quietSamples = 0;
+            inputIsSilent = false; //for the next stage
+        }
+        
+        pushTaps(static_cast<int>(i));
     }
-};
+}
 
-void VoxProcessorAudioProcessor::updateSmoothersFromParams(int numSamplesToSkip, SmootherUpdateMode init)
+juce::uint32 VoxProcessorAudioProcessor::getBypassMask() const
 {
-    auto paramsNeedingSmoothing = std::array
+    //indexed by DSP_Option
+    auto bypassParams = std::array
     {
-        phaserRateHz,
-        phaserCenterFreqHz,
-        phaserDepthPercent,
-        phaserFeedbackPercent,
-        phaserMixPercent,
-        chorusRateHz,
-        chorusDepthPercent,
-        chorusCenterDelayMs,
-        chorusFeedbackPercent,
-        chorusMixPercent,
-        overdriveSaturation,
-        ladderFilterCutoffHz,
-        ladderFilterResonance,
-        ladderFilterDrive,
-        generalFilterFreqHz,
-        generalFilterQuality,
-        generalFilterGain,
-        inputGain,
-        outputGain,
+        phaserBypass,
+        chorusBypass,
+        overdriveBypass,
+        ladderFilterBypass,
+        generalFilterBypass,
     };
+    static_assert(bypassParams.size() == static_cast<size_t>(DSP_Option::END_OF_LIST));
     
-    auto smoothers = getSmoothers();
-    jassert(paramsNeedingSmoothing.size() == smoothers.size());
+    juce::uint32 mask = 0;
+    for( size_t i = 0; i < bypassParams.size(); ++i )
+    {
+        if( bypassParams[i]->get() )
+            mask |= 1u << i;
+    }
+    return mask;
+}
+
+void VoxProcessorAudioProcessor::ChainEngine::compilePlan(juce::uint32 bypassMask)
+{
+    const auto toggled = plan.bypassMask ^ bypassMask;
+    plan.numStages = 0;
+    plan.bypassMask = bypassMask;
     
-    for(size_t i = 0; i < smoothers.size(); ++i)
+    for( auto option : order )
     {
-        auto smoother = smoothers[i];
-        auto param = paramsNeedingSmoothing[i];
+        if( option == DSP_Option::END_OF_LIST )
+        {
+            jassertfalse; //a broken order made it through setStateInformation()
+            continue;
+        }
         
-        if (init == SmootherUpdateMode::initialize) {
-            smoother->setCurrentAndTargetValue(param->get());
-        }else{
-            smoother->setTargetValue(param->get());
+        const auto bit = 1u << static_cast<juce::uint32>(option);
+        auto* oversampler = getOversampler(option);
+        
+        //the oversampling filters and the bypass delay hold the signal from before the switch,
+        //a stage coming out of bypass starts clean, with its parameters caught up
+        if( (toggled & bit) && ! (bypassMask & bit) )
+            resetStage(option);
+        else if( oversampler != nullptr && (toggled & bit) )
+            oversampler->reset();
+        
+        if( bypassMask & bit )
+        {
+#if VERIFY_BYPASS_FUNCTIONALITY
+            jassertfalse;
+#endif
+            //no oversampling is done for a bypassed stage, its latency is kept with a plain delay
+            if( oversampler != nullptr && oversampler->getLatencyInSamples() > 0 )
+            {
+                auto& stage = plan.stages[plan.numStages++];
+                stage.option = option;
+                stage.process = getBypassedStageFunction(option);
+            }
+        }
+        else
+        {
+            auto& stage = plan.stages[plan.numStages++];
+            stage.option = option;
+            stage.process = getStageFunction(option);
         }
         
-        smoother->skip(numSamplesToSkip);
+        //a bypassed stage without a delay is tapped after whatever ran before it
+        plan.tapAfterStage[static_cast<size_t>(option)] = static_cast<int>(plan.numStages) - 1;
+    }
+}
+
+void VoxProcessorAudioProcessor::setDspOrder(const DSP_Order& newOrder)
+{
+    const juce::SpinLock::ScopedLockType sl(dspOrderWriteLock);
+    publishedDspOrder = newOrder;
+    dspOrderBuffer.write(newOrder);
+}
+
+//==============================================================================
+void VoxProcessorAudioProcessor::beginReorder(juce::uint32 bypassMask)
+{
+    if( dspOrder == activeEngine->order )
+        return;
+    
+    auto numCrossfadeSamples = juce::roundToInt(reorderCrossfadeMs.get() * 0.001 * getSampleRate());
+    if( numCrossfadeSamples <= 0 )
+    {
+        activeEngine->order = dspOrder;
+        activeEngine->compilePlan(bypassMask);
+        return;
     }
     
+    //the idle chain starts from silence with the new order and fades in over the running one.
+    incomingEngine = activeEngine == &engineA ? &engineB : &engineA;
+    incomingEngine->reset();
+    incomingEngine->order = dspOrder;
+    incomingEngine->compilePlan(bypassMask);
+    
+    crossfadeLength = numCrossfadeSamples;
+    crossfadePosition = 0;
 }
 
-void VoxProcessorAudioProcessor::MonoChannelDSP::process(juce::dsp::AudioBlock<float> block, const DSP_Order &dspOrder)
+void VoxProcessorAudioProcessor::crossfadeToIncoming(juce::dsp::AudioBlock<float> block,
+                                                     juce::dsp::AudioBlock<float> incoming)
 {
-    //convert dspOrder into an array of pointers to the DSP objects
-    DSP_Pointers dspPointers;
-    dspPointers.fill({});
+    const auto numSamples = static_cast<int>(block.getNumSamples());
+    const auto increment = 1.f / static_cast<float>(crossfadeLength);
     
-    //We reasign the objects to their pointers if needed
-    for(size_t i = 0; i < dspPointers.size(); ++i)
+    //linear, the two chains see the same input so their outputs are strongly correlated
+    for( size_t ch = 0; ch < block.getNumChannels(); ++ch )
     {
-        switch (dspOrder[i])
+        auto* out = block.getChannelPointer(ch);
+        const auto* in = incoming.getChannelPointer(ch);
+        
+        for( int i = 0; i < numSamples; ++i )
         {
-            case DSP_Option::Phase:
-                dspPointers[i].processor = &phaser;
-                dspPointers[i].bypassed = p.phaserBypass->get();
-                break;
-            case DSP_Option::Chorus:
-                dspPointers[i].processor = &chorus;
-                dspPointers[i].bypassed = p.chorusBypass->get();
-                break;
-            case DSP_Option::OverDrive:
-                dspPointers[i].processor = &overdrive;
-                dspPointers[i].bypassed = p.overdriveBypass->get();
-                break;
-            case DSP_Option::LadderFilter:
-                dspPointers[i].processor = &ladderFilter;
-                dspPointers[i].bypassed = p.ladderFilterBypass->get();
-                break;
-            case DSP_Option::GeneralFilter:
-                dspPointers[i].processor = &generalFilter;
-                dspPointers[i].bypassed = p.generalFilterBypass->get();
-                break;
-            case DSP_Option::END_OF_LIST:
-                jassertfalse;
-                break;
+            auto gain = juce::jmin(1.f, static_cast<float>(crossfadePosition + i) * increment);
+            out[i] += (in[i] - out[i]) * gain;
         }
     }
     
-    //Now, with the list up to date we can process
-    auto context = juce::dsp::ProcessContextReplacing<float>(block);
+    crossfadePosition += numSamples;
+    if( crossfadePosition >= crossfadeLength )
+    {
+        //the old chain is retired, it is reset before it is used again
+        activeEngine = incomingEngine;
+        incomingEngine = nullptr;
+    }
+}
+
+bool VoxProcessorAudioProcessor::updateOversampling()
+{
+    if( oversamplingIsPrepared.get() )
+    {
+        //the idle chain follows too, so it is ready when the next reorder starts it
+        auto changed = engineA.switchOversampling();
+        changed |= engineB.switchOversampling();
+        oversamplingIsPrepared = false;
+        return changed;
+    }
+    
+    //a new mode is built on the message thread, the chains switch to it once it is there
+    if( activeEngine->overdriveOversampler.getMode() != getOversamplingMode(overdriveOversampling)
+        || activeEngine->ladderFilterOversampler.getMode() != getOversamplingMode(ladderFilterOversampling) )
+        triggerAsyncUpdate();
+    
+    return false;
+}
+
+void VoxProcessorAudioProcessor::prepareOversampling()
+{
+    //the audio thread hasn't switched to the last ones yet
+    if( oversamplingIsPrepared.get() )
+        return;
+    
+    //this also frees the filters the chains switched away from
+    const auto overdriveMode = getOversamplingMode(overdriveOversampling);
+    const auto ladderMode = getOversamplingMode(ladderFilterOversampling);
+    auto prepared = engineA.prepareOversampling(overdriveMode, ladderMode);
+    prepared |= engineB.prepareOversampling(overdriveMode, ladderMode);
+    
+    if( prepared )
+        oversamplingIsPrepared = true;
+}
+
+void VoxProcessorAudioProcessor::handleAsyncUpdate()
+{
+    prepareOversampling();
+    
+    //setLatencySamples() only tells the host when the latency is different
+    setLatencySamples(chainLatencySamples.get());
     
-    for(size_t i = 0; i < dspPointers.size(); ++i)
+    //there is no tail flag in ChangeDetails, hosts read getTailLengthSeconds() again when they refresh the plugin state
+    auto tail = tailLengthSeconds.get();
+    if( tail != notifiedTailLengthSeconds )
     {
-        if(dspPointers[i].processor != nullptr)
-        {
-            juce::ScopedValueSetter<bool> svs(context.isBypassed, dspPointers[i].bypassed);
-#if VERIFY_BYPASS_FUNCTIONALITY
-            if( context.isBypassed )
-            {
-                jassertfalse;
-            }
-            
-            if( dspPointers[i].processor == &generalFilter )
-            {
-                continue;
-            }
-#endif
-            dspPointers[i].processor->process(context);
-        }
+        notifiedTailLengthSeconds = tail;
+        updateHostDisplay(juce::AudioProcessorListener::ChangeDetails().withNonParameterStateChanged(true));
     }
 }
 
+bool VoxProcessorAudioProcessor::updateTailLength()
+{
+    auto tail = activeEngine->getTailLengthSeconds();
+    if( incomingEngine != nullptr )
+        tail = juce::jmax(tail, incomingEngine->getTailLengthSeconds());
+    
+    //rounded up to 50ms steps, so sweeping a feedback or resonance knob doesn't call the host on every block
+    auto rounded = static_cast<float>(std::ceil(tail * 20.0) / 20.0);
+    if( rounded == tailLengthSeconds.get() )
+        return false;
+    
+    tailLengthSeconds = rounded;
+    return true;
+}
+
 //==============================================================================
 void VoxProcessorAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
 {
@@ -508,51 +1095,196 @@ void VoxProcessorAudioProcessor::prepareToPlay (double sampleRate, int samplesPe
     juce::dsp::ProcessSpec spec;
     spec.sampleRate = sampleRate;
     spec.maximumBlockSize = samplesPerBlock;
-    spec.numChannels = 1;
+    //the chains are linked, every channel of the bus runs through the same DSP instances
+    const auto numChannels = juce::jmax(1, getTotalNumInputChannels(), getTotalNumOutputChannels());
+    spec.numChannels = static_cast<juce::uint32>(numChannels);
+    
+    //whatever was prepared for the old spec is dropped, the chains start on the selected modes
+    oversamplingIsPrepared = false;
+    const auto overdriveMode = getOversamplingMode(overdriveOversampling);
+    const auto ladderMode = getOversamplingMode(ladderFilterOversampling);
+    engineA.prepare(spec, overdriveMode, ladderMode);
+    engineB.prepare(spec, overdriveMode, ladderMode);
+    
+    maxChainBlockSize = static_cast<size_t>(juce::jmax(1, samplesPerBlock));
+    parameterEvents.prepare(maxParameterEventsPerBlock);
+    //enough frames for the smallest control block, setControlBlockSize() may still lower it
+    constexpr auto minFrameSize = static_cast<size_t>(minControlBlockSize);
+    controlFrames.resize((maxChainBlockSize + minFrameSize - 1) / minFrameSize);
+    crossfadeBuffer.setSize(numChannels, static_cast<int>(maxChainBlockSize));
+    
+    //nothing is playing yet, so the latest order is taken over without a crossfade
+    if( dspOrderBuffer.update() )
+        dspOrder = dspOrderBuffer.read();
+    
+    activeEngine = &engineA;
+    incomingEngine = nullptr;
+    activeEngine->order = dspOrder;
+    activeEngine->compilePlan(getBypassMask());
+    
+    //the host may ask for the latency right after this, so it is set here and not from the message thread
+    cancelPendingUpdate();
+    chainLatencySamples = activeEngine->getLatencyInSamples();
+    setLatencySamples(chainLatencySamples.get());
+    updateTailLength();
+    
+    parameterSmoothers.reset(sampleRate, 0.005);
+    updateSmoothersFromParams(1, SmootherUpdateMode::initialize);
+    updateRampedStageParameters(true);
     
-    leftChannel.prepare(spec);
-    rightChannel.prepare(spec);
+    //the gain stages pull one value per sample from their smoothers themselves
+    autoGainDSP.prepare(sampleRate);
+    inputGainSmoother.reset(sampleRate, 0.005);
+    outputGainSmoother.reset(sampleRate, 0.005);
+    inputGainSmoother.setCurrentAndTargetValue(inputGain->get());
+    outputGainSmoother.setCurrentAndTargetValue(getOutputGainTargetDb());
     
-    for(auto smoother : getSmoothers())
+    inputMeter.prepare(sampleRate, getTotalNumInputChannels());
+    outputMeter.prepare(sampleRate, getTotalNumOutputChannels());
+    
+    //the channel weights come from the layout, a bus without one is measured as plain channels
+    auto outputLayout = getChannelLayoutOfBus(false, 0);
+    if( outputLayout.size() != getTotalNumOutputChannels() )
+        outputLayout = juce::AudioChannelSet::discreteChannels(getTotalNumOutputChannels());
+    outputLoudness.prepare(sampleRate, outputLayout);
+    
+    spectrumAnalyses.prepare(sampleRate, getTotalNumOutputChannels());
+}
+
+VoxProcessorAudioProcessor::AnalysisSubscription::AnalysisSubscription(AnalysisSubscription&& other) noexcept
+    : processor(std::exchange(other.processor, nullptr)), feed(other.feed)
+{
+}
+
+VoxProcessorAudioProcessor::AnalysisSubscription& VoxProcessorAudioProcessor::AnalysisSubscription::operator=(AnalysisSubscription&& other) noexcept
+{
+    if( this != &other )
     {
-        smoother->reset(sampleRate, 0.005);
+        reset();
+        processor = std::exchange(other.processor, nullptr);
+        feed = other.feed;
     }
     
-    updateSmoothersFromParams(1, SmootherUpdateMode::initialize);
-    spec.numChannels = getTotalNumInputChannels();
-    inputGainDSP.prepare(spec);
-    outputGainDSP.prepare(spec);
-    
-    leftSCSF.prepare(samplesPerBlock);
-    rightSCSF.prepare(samplesPerBlock);
-}
-
-std::vector<juce::SmoothedValue<float>*> VoxProcessorAudioProcessor::getSmoothers()
-{
-    auto smoothers = std::vector
-    {
-        &phaserRateHzSmoother,
-        &phaserCenterFreqHzSmoother,
-        &phaserDepthPercentSmoother,
-        &phaserFeedbackPercentSmoother,
-        &phaserMixPercentSmoother,
-        &chorusRateHzSmoother,
-        &chorusDepthPercentSmoother,
-        &chorusCenterDelayMsSmoother,
-        &chorusFeedbackPercentSmoother,
-        &chorusMixPercentSmoother,
-        &overdriveSaturationSmoother,
-        &ladderFilterCutoffHzSmoother,
-        &ladderFilterResonanceSmoother,
-        &ladderFilterDriveSmoother,
-        &generalFilterFreqHzSmoother,
-        &generalFilterQualitySmoother,
-        &generalFilterGainSmoother,
-        &inputGainSmoother,
-        &outputGainSmoother,
-    };
+    return *this;
+}
+
+VoxProcessorAudioProcessor::AnalysisSubscription::~AnalysisSubscription()
+{
+    reset();
+}
+
+void VoxProcessorAudioProcessor::AnalysisSubscription::reset()
+{
+    if( auto* p = std::exchange(processor, nullptr) )
+        p->unsubscribe(feed);
+}
+
+VoxProcessorAudioProcessor::AnalysisSubscription VoxProcessorAudioProcessor::subscribe(AnalysisFeed feed)
+{
+    const juce::ScopedLock sl(subscriptionLock);
+    
+    auto& count = analysisSubscribers[static_cast<size_t>(feed)];
+    if( ++count == 1 && feed == AnalysisFeed::Spectrum )
+        spectrumAnalyses.start();
+    
+    return AnalysisSubscription(*this, feed);
+}
+
+void VoxProcessorAudioProcessor::unsubscribe(AnalysisFeed feed)
+{
+    const juce::ScopedLock sl(subscriptionLock);
+    
+    auto& count = analysisSubscribers[static_cast<size_t>(feed)];
+    jassert(count.get() > 0);
+    if( --count == 0 && feed == AnalysisFeed::Spectrum )
+        spectrumAnalyses.stop();
+}
+
+void VoxProcessorAudioProcessor::pushToAnalyzer(AnalysisTap tap, juce::dsp::AudioBlock<const float> block) noexcept
+{
+    for( size_t t = 0; t < numAnalyzerTraces; ++t )
+    {
+        if( analyzerTaps[t] == tap )
+            spectrumAnalyses.push(t, block);
+    }
+}
+
+bool VoxProcessorAudioProcessor::isSubscribed(AnalysisFeed feed) const noexcept
+{
+    return analysisSubscribers[static_cast<size_t>(feed)].get() > 0;
+}
+
+void VoxProcessorAudioProcessor::setControlBlockSize(int numSamples, bool adaptive)
+{
+    controlBlockSize = static_cast<size_t>(juce::jlimit(minControlBlockSize, maxControlBlockSize, numSamples));
+    adaptiveControlRate = adaptive;
+}
+
+bool VoxProcessorAudioProcessor::addParameterEvent(int sampleOffset, const juce::AudioParameterFloat* param, float value) noexcept
+{
+    auto it = std::find(smoothedParams.begin(), smoothedParams.end(), param);
+    if( it == smoothedParams.end() )
+        return false;
     
-    return smoothers;
+    return parameterEvents.add(sampleOffset, static_cast<int>(std::distance(smoothedParams.begin(), it)), value);
+}
+
+#if VOX_CLAP_DIRECT_EVENTS
+bool VoxProcessorAudioProcessor::supportsDirectEvent(uint16_t spaceId, uint16_t type)
+{
+    return spaceId == CLAP_CORE_EVENT_SPACE_ID && type == CLAP_EVENT_PARAM_VALUE;
+}
+
+void VoxProcessorAudioProcessor::handleDirectEvent(const clap_event_header_t* event, int sampleOffset)
+{
+    if( event->space_id != CLAP_CORE_EVENT_SPACE_ID || event->type != CLAP_EVENT_PARAM_VALUE )
+        return;
+    
+    const auto* paramEvent = reinterpret_cast<const clap_event_param_value_t*>(event);
+    auto it = std::lower_bound(directEventParams.begin(), directEventParams.end(), paramEvent->param_id,
+                               [](const DirectEventParameter& p, clap_id id) { return p.id < id; });
+    if( it == directEventParams.end() || it->id != paramEvent->param_id )
+        return;
+    
+    //the wrapper publishes JUCE's normalised range, and leaves setting the parameter to us
+    const auto normalised = static_cast<float>(paramEvent->value);
+    if( it->smoothedIndex >= 0 )
+    {
+        const auto index = static_cast<size_t>(it->smoothedIndex);
+        parameterEvents.add(sampleOffset, it->smoothedIndex, smoothedParams[index]->convertFrom0to1(normalised));
+    }
+    
+    //the parameter itself only takes the last value, see applyDirectEventValues()
+    if( ! it->hasValue )
+    {
+        it->hasValue = true;
+        changedDirectEventParams.push_back(&*it);
+    }
+    it->lastValue = normalised;
+}
+
+void VoxProcessorAudioProcessor::applyDirectEventValues()
+{
+    //the block end value, as the wrappers set it when they handle the events themselves:
+    //one update and one round of listeners per parameter, however many events it had
+    for( auto* p : changedDirectEventParams )
+    {
+        p->param->setValue(p->lastValue);
+        p->param->sendValueChangedMessageToListeners(p->lastValue);
+        p->hasValue = false;
+    }
+    
+    changedDirectEventParams.clear();
+}
+#endif
+
+float VoxProcessorAudioProcessor::getOutputGainTargetDb() const noexcept
+{
+    auto target = outputGain->get();
+    if( autoGain->get() )
+        target += autoGainDSP.getCorrectionDb();
+    
+    return target;
 }
 
 void VoxProcessorAudioProcessor::releaseResources()
@@ -568,12 +1300,9 @@ bool VoxProcessorAudioProcessor::isBusesLayoutSupported (const BusesLayout& layo
     juce::ignoreUnused (layouts);
     return true;
   #else
-    // This is the place where you check if the layout is supported.
-    // In this template code we only support mono or stereo.
-    // Some plugin hosts, such as certain GarageBand versions, will only
-    // load plugins that support stereo bus layouts.
-    if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
-     && layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
+    // Any channel count works, from mono to immersive beds like 7.1.4:
+    // every channel runs through the same linked chain, sized in prepareToPlay().
+    if (layouts.getMainOutputChannelSet().isDisabled())
         return false;
 
     // This checks if the input layout matches the output layout
@@ -592,6 +1321,10 @@ juce::AudioProcessorValueTreeState::ParameterLayout VoxProcessorAudioProcessor::
     juce::AudioProcessorValueTreeState::ParameterLayout layout;
     
     const int versionHint = 1;
+    const int oversamplingVersionHint = 2;
+    const int waveshaperVersionHint = 3;
+    const int autoGainVersionHint = 4;
+    const int analyzerTapVersionHint = 5;
     
     //====== Selected Tab
     auto name = getSelectedTabName();
@@ -612,6 +1345,53 @@ juce::AudioProcessorValueTreeState::ParameterLayout VoxProcessorAudioProcessor::
                                                            name,
                                                            juce::NormalisableRange<float>(-18, 18, 0.1,1.0),
                                                            0.0f));
+    
+    //====== Auto Gain
+    
+    //drives the output gain so the output level follows the input level
+    name = getAutoGainName();
+    layout.add(std::make_unique<juce::AudioParameterBool>(juce::ParameterID{name, autoGainVersionHint}, name, false));
+    
+    //freezes the correction where it is
+    name = getAutoGainHoldName();
+    layout.add(std::make_unique<juce::AudioParameterBool>(juce::ParameterID{name, autoGainVersionHint}, name, false));
+    
+    //how long the input and output levels are averaged over
+    name = getAutoGainWindowName();
+    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID{name, autoGainVersionHint},
+                                                           name,
+                                                           juce::NormalisableRange<float>(50.f, 5000.f, 1.f, 0.4f),
+                                                           400.f,
+                                                           "ms"));
+    //how fast the correction comes down
+    name = getAutoGainAttackName();
+    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID{name, autoGainVersionHint},
+                                                           name,
+                                                           juce::NormalisableRange<float>(10.f, 10000.f, 1.f, 0.3f),
+                                                           500.f,
+                                                           "ms"));
+    //how fast the correction goes back up
+    name = getAutoGainReleaseName();
+    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID{name, autoGainVersionHint},
+                                                           name,
+                                                           juce::NormalisableRange<float>(10.f, 10000.f, 1.f, 0.3f),
+                                                           2000.f,
+                                                           "ms"));
+    //====== Analyzer
+    
+    //the two traces: the output and nothing, until something else is picked
+    name = getAnalyzerTapAName();
+    layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID{name, analyzerTapVersionHint},
+                                                            name,
+                                                            getAnalyzerTapChoices(),
+                                                            static_cast<int>(AnalysisTap::Output)));
+    
+    name = getAnalyzerTapBName();
+    layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID{name, analyzerTapVersionHint},
+                                                            name,
+                                                            getAnalyzerTapChoices(),
+                                                            static_cast<int>(AnalysisTap::Off)));
+    
     //====== Phaser
     
     //phaser rate LFO Hz
@@ -704,6 +1484,27 @@ juce::AudioProcessorValueTreeState::ParameterLayout VoxProcessorAudioProcessor::
                                                            1.f,
                                                            ""));
     
+    //curve: tanh, soft clip, asymmetric tube
+    name = getOverdriveCurveName();
+    layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID{name, waveshaperVersionHint},
+                                                            name,
+                                                            VoxDSP::Waveshaper::getCurveNames(),
+                                                            0));
+    
+    //antiderivative antialiasing, cheaper than oversampling and can be combined with it
+    name = getOverdriveAntialiasingName();
+    layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID{name, waveshaperVersionHint},
+                                                            name,
+                                                            getOverdriveAntialiasingChoices(),
+                                                            0));
+    
+    //oversampling: off, 2x/4x/8x polyphase IIR (low latency) or linear phase FIR
+    name = getOverdriveOversamplingName();
+    layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID{name, oversamplingVersionHint},
+                                                            name,
+                                                            VoxDSP::StageOversampling::getModeNames(),
+                                                            0));
+    
     name = getOverdriveBypassName();
     layout.add(std::make_unique<juce::AudioParameterBool>(juce::ParameterID{name, versionHint}, name, false));
     
@@ -738,6 +1539,12 @@ juce::AudioProcessorValueTreeState::ParameterLayout VoxProcessorAudioProcessor::
                                                            1.f,
                                                            ""));
     
+    name = getLadderFilterOversamplingName();
+    layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID{name, oversamplingVersionHint},
+                                                            name,
+                                                            VoxDSP::StageOversampling::getModeNames(),
+                                                            0));
+    
     name = getLadderFilterBypassName();
     layout.add(std::make_unique<juce::AudioParameterBool>(juce::ParameterID{name, versionHint}, name, false));
     
@@ -802,6 +1609,12 @@ void VoxProcessorAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer,
     //TODO: prepare all DSP
     
     juce::ScopedNoDenormals noDenormals;
+    stageTicks.fill(0);
+    
+   #if VOX_CLAP_DIRECT_EVENTS
+    applyDirectEventValues();
+   #endif
+    
     auto totalNumInputChannels  = getTotalNumInputChannels();
     auto totalNumOutputChannels = getTotalNumOutputChannels();
 
@@ -815,22 +1628,31 @@ void VoxProcessorAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer,
         buffer.clear (i, 0, buffer.getNumSamples());
     
     
-    leftChannel.updateDSPFromParams();
-    rightChannel.updateDSPFromParams();
+    //the plans are only recompiled when setDspOrder() published a new order, a bypass was toggled
+    //or an oversampling mode changed. A new order waits in the triple buffer until the current crossfade is done.
+    auto bypassMask = getBypassMask();
+    auto oversamplingChanged = updateOversampling();
+    if( oversamplingChanged || bypassMask != activeEngine->plan.bypassMask )
+    {
+        activeEngine->compilePlan(bypassMask);
+        if( incomingEngine != nullptr )
+            incomingEngine->compilePlan(bypassMask);
+    }
     
-    //Temp instance to pull into
-    auto newDSPOrder = DSP_Order(); // <-- This is just an array
+    if( oversamplingChanged )
+    {
+        chainLatencySamples = activeEngine->getLatencyInSamples();
+        triggerAsyncUpdate();
+    }
     
-    //Try to pull from the Fifo
-    while(dspOrderFifo.pull(newDSPOrder))
+    if( updateTailLength() )
+        triggerAsyncUpdate();
+    
+    if( incomingEngine == nullptr && dspOrderBuffer.update() )
     {
-#if VERIFY_BYPASS_FUNCTIONALITY
-        jassertfalse;
-#endif
+        dspOrder = dspOrderBuffer.read();
+        beginReorder(bypassMask);
     }
-    //If pull succeeded, we refresh dspOrder
-    if(newDSPOrder != DSP_Order())
-        dspOrder = newDSPOrder;
     
     if (guiNeedsLatestDspOrder.compareAndSetBool(false, true))
     {
@@ -841,51 +1663,166 @@ void VoxProcessorAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer,
 //    leftChannel.process(block.getSingleChannelBlock(0), dspOrder);
 //    rightChannel.process(block.getSingleChannelBlock(1), dspOrder);
     const auto numSamples = buffer.getNumSamples();
-    auto samplesRemaining = numSamples;
-    auto maxSamplesToProcess = juce::jmin(samplesRemaining, 64);
     
     auto block = juce::dsp::AudioBlock<float>(buffer);
     
-    //This block is to pass the smoothed value from pre gain to the meters.
-    auto preCtx = juce::dsp::ProcessContextReplacing<float>(block);
+    //without subscribers the meters only collect the block levels for the auto gain and the idle detection
+    const auto metersAreSubscribed = isSubscribed(AnalysisFeed::LevelMeters);
+    inputMeter.setReadingsEnabled(metersAreSubscribed);
+    outputMeter.setReadingsEnabled(metersAreSubscribed);
     
-    inputGainSmoother.setTargetValue( inputGain->get() );
-    outputGainSmoother.setTargetValue( outputGain->get() );
-    inputGainDSP.setGainDecibels( inputGainSmoother.getNextValue() );
-    inputGainDSP.process(preCtx);
+    //the gain is ramped per sample and metered in the same pass, so the input meter is timed with it.
+    {
+        VOX_PROFILE_STAGE(stageTicks, ProfiledStage::InputGain);
+        inputGainSmoother.setTargetValue( inputGain->get() );
+        inputMeter.processWithGain(block, inputGainSmoother);
+    }
+    
+    //the input meter found the peak on its pass. Silence lets the stages go to sleep once their tails have died away,
+    //channels the meter doesn't see are never taken for silence.
+    const auto chainInputIsSilent = inputMeter.getBlockPeak() < ChainEngine::silenceThreshold
+                                    && static_cast<size_t>(totalNumInputChannels) <= VoxDSP::LevelMeter::maxChannels;
+    
+    //the analyzer traces only listen while the spectrum is subscribed
+    const auto spectrumIsSubscribed = isSubscribed(AnalysisFeed::Spectrum);
+    const auto tapParams = std::array { analyzerTapA, analyzerTapB };
+    static_assert(tapParams.size() == numAnalyzerTraces);
+    for( size_t t = 0; t < numAnalyzerTraces; ++t )
+        analyzerTaps[t] = spectrumIsSubscribed ? static_cast<AnalysisTap>(tapParams[t]->getIndex()) : AnalysisTap::Off;
     
-    leftPreRMS.set(buffer.getRMSLevel(0, 0, numSamples));
-    rightPreRMS.set(buffer.getRMSLevel(1, 0, numSamples));
+    pushToAnalyzer(AnalysisTap::Input, block);
+    
+    //parameters without events this block head for their current value from the start of the block
+    const auto eventMask = parameterEvents.getParameterMask();
+    for( size_t i = 0; i < smoothedParams.size(); ++i )
+    {
+        if( (eventMask & (1u << i)) == 0 )
+            automationTargets[i] = smoothedParams[i]->get();
+    }
+    
+    //the chain is split where the events are, and the control frames are sized in prepareToPlay(),
+    //hosts that send bigger blocks get them in slices.
+    auto applyEvents = [this, nextEvent = parameterEvents.begin()](size_t upToSample) mutable
+    {
+        for( ; nextEvent != parameterEvents.end() && static_cast<size_t>(nextEvent->sampleOffset) <= upToSample; ++nextEvent )
+            automationTargets[static_cast<size_t>(nextEvent->parameterIndex)] = nextEvent->value;
+        
+        return nextEvent != parameterEvents.end() ? static_cast<size_t>(nextEvent->sampleOffset) : std::numeric_limits<size_t>::max();
+    };
     
     size_t startSample = 0;
-    while (samplesRemaining > 0)
+    const auto totalSamples = static_cast<size_t>(numSamples);
+    jassert(maxChainBlockSize > 0); //prepareToPlay() must be called first
+    while (startSample < totalSamples && maxChainBlockSize > 0)
     {
-        auto samplesToProcess = juce::jmin(samplesRemaining, maxSamplesToProcess);
-        updateSmoothersFromParams(samplesToProcess, SmootherUpdateMode::liveInRealTime);
+        auto nextEventSample = applyEvents(startSample);
+        auto samplesToProcess = juce::jmin(totalSamples, nextEventSample) - startSample;
+        samplesToProcess = juce::jmin(samplesToProcess, maxChainBlockSize);
+        processChain(block.getSubBlock(startSample, samplesToProcess), chainInputIsSilent);
         
-        leftChannel.updateDSPFromParams();
-        rightChannel.updateDSPFromParams();
+        startSample += samplesToProcess;
+    }
+    
+    //events past the end of the block still leave their value behind
+    applyEvents(std::numeric_limits<size_t>::max());
+    parameterEvents.clear();
+    
+    //same for the output gain and the output meter
+    {
+        VOX_PROFILE_STAGE(stageTicks, ProfiledStage::OutputGain);
+        outputGainSmoother.setTargetValue( getOutputGainTargetDb() );
+        outputMeter.processWithGain(block, outputGainSmoother);
+    }
+    
+    {
+        VOX_PROFILE_STAGE(stageTicks, ProfiledStage::Metering);
+        const auto measureLoudness = isSubscribed(AnalysisFeed::Loudness);
+        if( measureLoudness && ! loudnessWasMeasured )
+            outputLoudness.reset();
         
-        auto subBlock = block.getSubBlock(startSample, samplesToProcess);
-        leftChannel.process(subBlock.getSingleChannelBlock(0), dspOrder);
-        rightChannel.process(subBlock.getSingleChannelBlock(1), dspOrder);
+        loudnessWasMeasured = measureLoudness;
+        if( measureLoudness )
+            outputLoudness.process(block);
         
-        startSample += samplesToProcess;
-        samplesRemaining -= samplesToProcess;
+        //the meters already collected both levels, the auto gain only needs their block means
+        autoGainDSP.setTimeConstants(autoGainWindowMs->get(), autoGainAttackMs->get(), autoGainReleaseMs->get());
+        autoGainDSP.setHold(autoGainHold->get());
+        autoGainDSP.process(inputMeter.getBlockMeanSquare(),
+                            outputMeter.getBlockMeanSquare(),
+                            outputGainSmoother.getCurrentValue(),
+                            numSamples);
     }
     
-    //This block is to pass the smoothed value from post gain to the meters.
-    auto postCtx = juce::dsp::ProcessContextReplacing<float>(block);
+    {
+        VOX_PROFILE_STAGE(stageTicks, ProfiledStage::AnalyzerFifo);
+        pushToAnalyzer(AnalysisTap::Output, block);
+    }
+}
+
+void VoxProcessorAudioProcessor::processChain(juce::dsp::AudioBlock<float> block, bool inputIsSilent)
+{
+    const auto numSamples = block.getNumSamples();
+    jassert(numSamples <= maxChainBlockSize);
     
-    outputGainSmoother.setTargetValue( outputGain->get() );
-    outputGainDSP.setGainDecibels( inputGainSmoother.getNextValue() );
-    outputGainDSP.process(postCtx);
+    updateControlRate(numSamples);
     
-    leftPostRMS.set(buffer.getRMSLevel(0, 0, numSamples));
-    rightPostRMS.set(buffer.getRMSLevel(1, 0, numSamples));
+    if( incomingEngine != nullptr )
+    {
+        auto incoming = juce::dsp::AudioBlock<float>(crossfadeBuffer).getSubBlock(0, numSamples);
+        incoming.copyFrom(block);
+        //the analyzer already listens to the order being faded in
+        incomingEngine->process(incoming, controlFrames.data(), numControlFrames, inputIsSilent, true);
+        activeEngine->process(block, controlFrames.data(), numControlFrames, inputIsSilent, false);
+        crossfadeToIncoming(block, incoming);
+        return;
+    }
     
-    leftSCSF.update(buffer);
-    rightSCSF.update(buffer);
+    activeEngine->process(block, controlFrames.data(), numControlFrames, inputIsSilent, true);
+}
+
+void VoxProcessorAudioProcessor::updateControlRate(size_t numSamples)
+{
+    VOX_PROFILE_STAGE(stageTicks, ProfiledStage::Control);
+    
+    //the targets don't change inside a chain block, processBlock() splits it at the parameter events
+    updateSmoothersFromParams(0, SmootherUpdateMode::liveInRealTime);
+    
+    //advance the smoothers one control block at a time, keeping what the control rate stages need for each block.
+    //once nothing moves the rest of the block is one frame.
+    numControlFrames = 0;
+    for( size_t start = 0; start < numSamples; )
+    {
+        auto samplesToProcess = numSamples - start;
+        if( ! adaptiveControlRate || parameterSmoothers.isAnySmoothing() )
+            samplesToProcess = juce::jmin(samplesToProcess, controlBlockSize);
+        
+        parameterSmoothers.skip(static_cast<int>(samplesToProcess));
+        
+        auto& frame = controlFrames[numControlFrames++];
+        frame.startSample = start;
+        frame.numSamples = samplesToProcess;
+        
+        frame.phaserRateHz = getSmoothedValue(SmoothedParam::PhaserRateHz);
+        frame.phaserCenterFreqHz = getSmoothedValue(SmoothedParam::PhaserCenterFreqHz);
+        frame.phaserDepth = getSmoothedValue(SmoothedParam::PhaserDepthPercent) * 0.01f;
+        frame.phaserFeedback = getSmoothedValue(SmoothedParam::PhaserFeedbackPercent) * 0.01f;
+        frame.phaserMix = getSmoothedValue(SmoothedParam::PhaserMixPercent) * 0.01f;
+        
+        frame.chorusRateHz = getSmoothedValue(SmoothedParam::ChorusRateHz);
+        frame.chorusDepth = getSmoothedValue(SmoothedParam::ChorusDepthPercent) * 0.01f;
+        frame.chorusCenterDelayMs = getSmoothedValue(SmoothedParam::ChorusCenterDelayMs);
+        frame.chorusFeedback = getSmoothedValue(SmoothedParam::ChorusFeedbackPercent) * 0.01f;
+        frame.chorusMix = getSmoothedValue(SmoothedParam::ChorusMixPercent) * 0.01f;
+        
+        frame.overdriveSaturation = getSmoothedValue(SmoothedParam::OverdriveSaturation);
+        
+        start += samplesToProcess;
+    }
+    
+    updateRampedStageParameters(false);
+    activeEngine->updateRampedStages();
+    if( incomingEngine != nullptr )
+        incomingEngine->updateRampedStages();
 }
 
 //==============================================================================
@@ -957,8 +1894,15 @@ void VoxProcessorAudioProcessor::getStateInformation (juce::MemoryBlock& destDat
     // You should use this method to store your parameters in the memory block.
     // You could do that either as raw data, or use the XML or ValueTree classes
     // as intermediaries to make it easy to save and load complex data.
+    DSP_Order order;
+    {
+        //dspOrder belongs to the audio thread, save the last order handed to it instead
+        const juce::SpinLock::ScopedLockType sl(dspOrderWriteLock);
+        order = publishedDspOrder;
+    }
+    
     apvts.state.setProperty("dspOrder",
-                            juce::VariantConverter<VoxProcessorAudioProcessor::DSP_Order>::toVar(dspOrder),
+                            juce::VariantConverter<VoxProcessorAudioProcessor::DSP_Order>::toVar(order),
                             nullptr);
     
     juce::MemoryOutputStream mos(destData, false);
@@ -977,7 +1921,7 @@ void VoxProcessorAudioProcessor::setStateInformation (const void* data, int size
         if( apvts.state.hasProperty("dspOrder"))
         {
             auto order = juce::VariantConverter<VoxProcessorAudioProcessor::DSP_Order>::fromVar(apvts.state.getProperty("dspOrder"));
-            dspOrderFifo.push(order);
+            setDspOrder(order);
             restoreDspOrderFifo.push(order);
         }
         DBG(apvts.state.toXmlString());
@@ -991,7 +1935,7 @@ void VoxProcessorAudioProcessor::setStateInformation (const void* data, int size
             
             //bypass the Chorus
             chorusBypass->setValueNotifyingHost(1.f);
-            dspOrderFifo.push(order);
+            setDspOrder(order);
         });
 #endif
         
@@ -1031,6 +1975,9 @@ std::vector<juce::RangedAudioParameter*> VoxProcessorAudioProcessor::getParamsFo
             return
             {
                 overdriveSaturation,
+                overdriveCurve,
+                overdriveAntialiasing,
+                overdriveOversampling,
                 overdriveBypass,
             };
         }
@@ -1042,6 +1989,7 @@ std::vector<juce::RangedAudioParameter*> VoxProcessorAudioProcessor::getParamsFo
                 ladderFilterCutoffHz,
                 ladderFilterResonance,
                 ladderFilterDrive,
+                ladderFilterOversampling,
                 ladderFilterBypass,
             };
         }
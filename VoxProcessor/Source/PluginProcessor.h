@@ -10,15 +10,48 @@
 
 #include <JuceHeader.h>
 #include <Fifo.h>
-#include <SingleChannelSampleFifo.h>
+#include "DSP/GeneralFilter.h"
+#include "DSP/LadderFilter.h"
+#include "DSP/AutoGain.h"
+#include "DSP/LevelMeter.h"
+#include "DSP/LoudnessMeter.h"
+#include "DSP/ParameterEvents.h"
+#include "DSP/SmootherBank.h"
+#include "DSP/SpectrumAnalysis.h"
+#include "DSP/StageOversampling.h"
+#include "DSP/Waveshaper.h"
+#include "DSP/TripleBuffer.h"
+
+//Per stage timing for the benchmark in VoxRender. Off in the plugin, the timers compile to nothing.
+#ifndef VOX_STAGE_PROFILING
+ #define VOX_STAGE_PROFILING 0
+#endif
+
+//Sample accurate automation from CLAP hosts, through clap-juce-extensions' direct events.
+//On whenever the CLAP build puts clap-juce-extensions on the include path.
+#ifndef VOX_CLAP_DIRECT_EVENTS
+ #if __has_include(<clap-juce-extensions/clap-juce-extensions.h>)
+  #define VOX_CLAP_DIRECT_EVENTS 1
+ #else
+  #define VOX_CLAP_DIRECT_EVENTS 0
+ #endif
+#endif
+
+#if VOX_CLAP_DIRECT_EVENTS
+ #include <clap-juce-extensions/clap-juce-extensions.h>
+#endif
 
 //==============================================================================
 /**
 */
-class VoxProcessorAudioProcessor  : public juce::AudioProcessor
+class VoxProcessorAudioProcessor  : public juce::AudioProcessor,
+                                    private juce::AsyncUpdater
                             #if JucePlugin_Enable_ARA
                              , public juce::AudioProcessorARAExtension
                             #endif
+                            #if VOX_CLAP_DIRECT_EVENTS
+                             , public clap_juce_extensions::clap_juce_audio_processor_capabilities
+                            #endif
 {
 public:
     //==============================================================================
@@ -58,14 +91,9 @@ public:
     void getStateInformation (juce::MemoryBlock& destData) override;
     void setStateInformation (const void* data, int sizeInBytes) override;
     
-    enum class GeneralFilterMode
-    {
-        Peak,
-        Bandpass,
-        Notch,
-        Allpass,
-        END_OF_LIST
-    };
+    using GeneralFilterMode = VoxDSP::GeneralFilterMode;
+    using OversamplingMode = VoxDSP::StageOversampling::Mode;
+    using OverdriveCurve = VoxDSP::Waveshaper::Curve;
     
     enum class DSP_Option
     {
@@ -78,14 +106,10 @@ public:
     };
     
     using DSP_Order = std::array<DSP_Option, static_cast<size_t>(DSP_Option::END_OF_LIST)>;
-    SimpleMBComp::Fifo<DSP_Order> dspOrderFifo, restoreDspOrderFifo;
+    SimpleMBComp::Fifo<DSP_Order> restoreDspOrderFifo;
     
-    struct ProcessState
-    {
-        juce::dsp::ProcessorBase* processor = nullptr;
-        bool bypassed = false;
-    };
-    using DSP_Pointers = std::array<ProcessState, static_cast<size_t>(DSP_Option::END_OF_LIST)>;
+    //Hands a new order to the audio thread without locking it. The plan is recompiled at the start of the next block.
+    void setDspOrder(const DSP_Order& newOrder);
     
     static juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
     juce::AudioProcessorValueTreeState apvts {*this, nullptr, "Settings", createParameterLayout()};
@@ -105,8 +129,12 @@ public:
     juce::AudioParameterFloat* chorusMixPercent = nullptr;
     
     juce::AudioParameterFloat* overdriveSaturation = nullptr;
+    juce::AudioParameterChoice* overdriveCurve = nullptr;
+    juce::AudioParameterChoice* overdriveAntialiasing = nullptr;
+    juce::AudioParameterChoice* overdriveOversampling = nullptr;
     
     juce::AudioParameterChoice* ladderFilterMode = nullptr;
+    juce::AudioParameterChoice* ladderFilterOversampling = nullptr;
     juce::AudioParameterFloat* ladderFilterCutoffHz = nullptr;
     juce::AudioParameterFloat* ladderFilterResonance = nullptr;
     juce::AudioParameterFloat* ladderFilterDrive = nullptr;
@@ -127,39 +155,187 @@ public:
     juce::AudioParameterFloat* inputGain = nullptr;
     juce::AudioParameterFloat* outputGain = nullptr;
     
-    juce::SmoothedValue<float>
-    phaserRateHzSmoother,
-    phaserCenterFreqHzSmoother,
-    phaserDepthPercentSmoother,
-    phaserFeedbackPercentSmoother,
-    phaserMixPercentSmoother,
-    chorusRateHzSmoother,
-    chorusDepthPercentSmoother,
-    chorusCenterDelayMsSmoother,
-    chorusFeedbackPercentSmoother,
-    chorusMixPercentSmoother,
-    overdriveSaturationSmoother,
-    ladderFilterCutoffHzSmoother,
-    ladderFilterResonanceSmoother,
-    ladderFilterDriveSmoother,
-    generalFilterFreqHzSmoother,
-    generalFilterQualitySmoother,
-    generalFilterGainSmoother,
-    inputGainSmoother,
-    outputGainSmoother;
+    juce::AudioParameterBool* autoGain = nullptr;
+    juce::AudioParameterBool* autoGainHold = nullptr;
+    juce::AudioParameterFloat* autoGainWindowMs = nullptr;
+    juce::AudioParameterFloat* autoGainAttackMs = nullptr;
+    juce::AudioParameterFloat* autoGainReleaseMs = nullptr;
+    
+    //what the two analyzer traces listen to, see AnalysisTap
+    juce::AudioParameterChoice* analyzerTapA = nullptr;
+    juce::AudioParameterChoice* analyzerTapB = nullptr;
+    
+    //the control rate parameters, smoothed together in parameterSmoothers
+    enum class SmoothedParam
+    {
+        PhaserRateHz,
+        PhaserCenterFreqHz,
+        PhaserDepthPercent,
+        PhaserFeedbackPercent,
+        PhaserMixPercent,
+        ChorusRateHz,
+        ChorusDepthPercent,
+        ChorusCenterDelayMs,
+        ChorusFeedbackPercent,
+        ChorusMixPercent,
+        OverdriveSaturation,
+        LadderFilterCutoffHz,
+        LadderFilterResonance,
+        LadderFilterDrive,
+        GeneralFilterFreqHz,
+        GeneralFilterQuality,
+        GeneralFilterGain,
+        END_OF_LIST
+    };
+    static constexpr size_t numSmoothedParams = static_cast<size_t>(SmoothedParam::END_OF_LIST);
+    
+    VoxDSP::SmootherBank<numSmoothedParams> parameterSmoothers;
+    float getSmoothedValue(SmoothedParam param) const noexcept { return parameterSmoothers.getCurrentValue(static_cast<size_t>(param)); }
+    
+    /*
+     Sample accurate automation of the smoothed parameters, value in the parameter's own range.
+     Audio thread only, between two processBlock() calls: the events belong to the next block, sampleOffset
+     is relative to its start, and processBlock() splits the chain at the offsets and then clears the list.
+     From any other thread it races with processBlock().
+     The CLAP build feeds it from the host's parameter events (handleDirectEvent() below). JUCE's VST3 and AU
+     wrappers consume the host's parameter queues themselves, so there the parameters still move once per block.
+     Returns false for a parameter that isn't smoothed, or when the block's event list is full.
+     */
+    bool addParameterEvent(int sampleOffset, const juce::AudioParameterFloat* param, float value) noexcept;
+    
+   #if VOX_CLAP_DIRECT_EVENTS
+    //The CLAP wrapper hands the value changes of the smoothed parameters over here, on the audio thread,
+    //before the processBlock() they belong to. Everything else goes the usual way.
+    bool supportsDirectEvent(uint16_t spaceId, uint16_t type) override;
+    void handleDirectEvent(const clap_event_header_t* event, int sampleOffset) override;
+   #endif
+    
+    /*
+     While any smoother is moving, the control rate stages are updated every numSamples (clamped to 16..1024).
+     With adaptive on, the rest of the block is one control block as soon as every smoother has arrived,
+     so static settings cost one update per block whatever the host's block size.
+     Call while the audio thread is stopped. prepareToPlay() sizes the control frames for minControlBlockSize,
+     so this can come before or after it.
+     */
+    void setControlBlockSize(int numSamples, bool adaptive = true);
+    static constexpr int defaultControlBlockSize = 64;
+    static constexpr int minControlBlockSize = 16, maxControlBlockSize = 1024;
+    
+    //the gain stages ramp per sample, they keep their own smoothers
+    juce::SmoothedValue<float> inputGainSmoother, outputGainSmoother;
     
     juce::Atomic<bool> guiNeedsLatestDspOrder { false }; 
-    juce::Atomic<float> leftPreRMS, rightPreRMS, leftPostRMS, rightPostRMS;
     
-    SimpleMBComp::SingleChannelSampleFifo<juce::AudioBuffer<float>> leftSCSF { SimpleMBComp::Channel::Left }, rightSCSF { SimpleMBComp::Channel::Right };
+    //input after the input gain, output after the output gain. The editor pulls their snapshots.
+    //Their readings only move while AnalysisFeed::LevelMeters is subscribed.
+    VoxDSP::LevelMeter inputMeter, outputMeter;
+    
+    //BS.1770 loudness of the output bus, read by the editor and the offline renderer.
+    //Only measured while AnalysisFeed::Loudness is subscribed, and started from scratch when it is subscribed again.
+    VoxDSP::LoudnessMeter outputLoudness;
+    
+    //How often the ladder and general filter coefficients advance while a parameter is moving, in samples.
+    juce::Atomic<int> coefficientRampInterval { 1 };
+    
+    //How long the old and new chain run side by side after a reorder. 0 switches instantly.
+    juce::Atomic<float> reorderCrossfadeMs { 30.f };
+    
+    /*
+     Where an analyzer trace listens: after one of the stages (the first five line up with DSP_Option),
+     at the chain input after the input gain, or at the output after the output gain.
+     A tap after a stage that is bypassed or asleep hears what passes it by.
+     */
+    enum class AnalysisTap
+    {
+        Phaser,
+        Chorus,
+        OverDrive,
+        LadderFilter,
+        GeneralFilter,
+        Input,
+        Output,
+        Off,
+        END_OF_LIST
+    };
+    
+    //One spectrum per analyzer trace, analysed on one shared thread while AnalysisFeed::Spectrum is subscribed.
+    //Only the selected taps are pushed, straight from the chain's block into the analysis ring.
+    static constexpr size_t numAnalyzerTraces = 2;
+    VoxDSP::SpectrumAnalysisBank<numAnalyzerTraces> spectrumAnalyses;
+    
+    /*
+     The metering and analysis only run while something consumes them: an open editor, the offline
+     renderer's loudness report, a remote meter. Each consumer holds a subscription to the feeds it reads,
+     and a feed stays on as long as at least one subscription to it exists.
+     With nothing subscribed processBlock() only collects what the auto gain and the idle detection need.
+     */
+    enum class AnalysisFeed
+    {
+        LevelMeters,
+        Loudness,
+        Spectrum,
+        END_OF_LIST
+    };
+    
+    //Unsubscribes when destroyed. Can be moved, not copied.
+    class AnalysisSubscription
+    {
+    public:
+        AnalysisSubscription() = default;
+        AnalysisSubscription(AnalysisSubscription&& other) noexcept;
+        AnalysisSubscription& operator=(AnalysisSubscription&& other) noexcept;
+        ~AnalysisSubscription();
+        
+        void reset();
+        
+    private:
+        friend class VoxProcessorAudioProcessor;
+        AnalysisSubscription(VoxProcessorAudioProcessor& p, AnalysisFeed f) : processor(&p), feed(f) {}
+        
+        VoxProcessorAudioProcessor* processor = nullptr;
+        AnalysisFeed feed = AnalysisFeed::END_OF_LIST;
+        
+        JUCE_DECLARE_NON_COPYABLE(AnalysisSubscription)
+    };
+    
+    //Any thread but the audio thread. The spectrum worker is started by the first subscription and stopped after the last.
+    [[nodiscard]] AnalysisSubscription subscribe(AnalysisFeed feed);
+    bool isSubscribed(AnalysisFeed feed) const noexcept;
     
     std::vector<juce::RangedAudioParameter*> getParamsForOption(DSP_Option option);
     
+    //The first five line up with DSP_Option
+    enum class ProfiledStage
+    {
+        Phaser,
+        Chorus,
+        OverDrive,
+        LadderFilter,
+        GeneralFilter,
+        InputGain,
+        OutputGain,
+        Metering,
+        AnalyzerFifo,
+        Control,
+        END_OF_LIST
+    };
+    using StageTicks = std::array<juce::int64, static_cast<size_t>(ProfiledStage::END_OF_LIST)>;
+    
+    //High resolution ticks spent in each stage during the last processBlock() call. All zero unless VOX_STAGE_PROFILING is on.
+    const StageTicks& getLastBlockStageTicks() const noexcept { return stageTicks; }
+    
 private:
     //==============================================================================
-    DSP_Order dspOrder;
+    DSP_Order dspOrder; //audio thread
+    
+    //the editor and setStateInformation() write here, processBlock() picks the latest one up
+    VoxDSP::TripleBuffer<DSP_Order> dspOrderBuffer;
+    DSP_Order publishedDspOrder;
+    juce::SpinLock dspOrderWriteLock;
     
-    juce::dsp::Gain<float> inputGainDSP, outputGainDSP;
+    //matches the output level to the input level when the Auto Gain parameter is on
+    VoxDSP::AutoGain autoGainDSP;
+    float getOutputGainTargetDb() const noexcept;
     
     template<typename DSP>
     struct DSP_Choice : juce::dsp::ProcessorBase
@@ -180,29 +356,212 @@ private:
         DSP dsp;
     };
     
-    struct MonoChannelDSP
+    /*
+     The phaser, chorus and overdrive are still updated at control rate.
+     One frame is captured per control block with the smoothed values they need for that block.
+     The ladder and general filter ramp their coefficients per sample and run the whole block.
+     */
+    struct ControlFrame
     {
-        MonoChannelDSP(VoxProcessorAudioProcessor& proc) : p(proc){}
-            
+        size_t startSample = 0;
+        size_t numSamples = 0;
+        
+        float phaserRateHz = 0.f, phaserCenterFreqHz = 0.f, phaserDepth = 0.f, phaserFeedback = 0.f, phaserMix = 0.f;
+        float chorusRateHz = 0.f, chorusDepth = 0.f, chorusCenterDelayMs = 0.f, chorusFeedback = 0.f, chorusMix = 0.f;
+        float overdriveSaturation = 1.f;
+    };
+    
+    /*
+     The ladder and general filter settings at the end of the chain block, worked out once and shared by both chains,
+     so a crossfade doesn't read the parameters or design the coefficients twice.
+     The general filter coefficients are only redesigned when one of their inputs changed.
+     */
+    struct RampedStageParameters
+    {
+        int rampInterval = 1;
+        
+        juce::dsp::LadderFilterMode ladderFilterMode = juce::dsp::LadderFilterMode::LPF12;
+        float ladderFilterCutoffHz = 200.f, ladderFilterResonance = 0.f, ladderFilterDrive = 1.f;
+        
+        GeneralFilterMode generalFilterMode = GeneralFilterMode::END_OF_LIST;
+        float generalFilterFreqHz = 0.f, generalFilterQuality = 0.f, generalFilterGain = -100.f;
+        VoxDSP::GeneralFilter::Coefficients generalFilterCoefficients {};
+    };
+    
+    RampedStageParameters rampedStageParams;
+    void updateRampedStageParameters(bool redesign);
+    
+    size_t controlBlockSize = defaultControlBlockSize;
+    bool adaptiveControlRate = true;
+    std::vector<ControlFrame> controlFrames;
+    size_t numControlFrames = 0;
+    size_t maxChainBlockSize = 0;
+    
+    void processChain(juce::dsp::AudioBlock<float> block, bool inputIsSilent);
+    void updateControlRate(size_t numSamples);
+    
+    struct ChainEngine;
+    using StageFunction = void (*)(ChainEngine&, juce::dsp::AudioBlock<float>, const ControlFrame*, size_t);
+    
+    /*
+     The chain, flattened: the stages that aren't bypassed, in order, each with the function that runs it.
+     A bypassed stage that is oversampled leaves a delay behind, so the chain latency doesn't depend on the bypasses.
+     It is only rebuilt when the order, a bypass or an oversampling mode changes, so the per block work is a walk over this array.
+     */
+    struct ProcessingPlan
+    {
+        struct Stage
+        {
+            DSP_Option option = DSP_Option::END_OF_LIST;
+            StageFunction process = nullptr;
+        };
+        
+        std::array<Stage, static_cast<size_t>(DSP_Option::END_OF_LIST)> stages;
+        size_t numStages = 0;
+        juce::uint32 bypassMask = 0;
+        
+        //for each DSP_Option, the index of the stage its analyzer tap comes after. -1 is the chain input.
+        std::array<int, static_cast<size_t>(DSP_Option::END_OF_LIST)> tapAfterStage {};
+    };
+    
+    juce::uint32 getBypassMask() const;
+    
+    /*
+     A complete chain with its own stage states, processing every channel at once.
+     The channels are linked: one LFO and one set of coefficients drive all of them, so parameters are
+     computed once per block instead of once per channel, and the filters run the channels in SIMD lanes.
+     There are two of them so a reorder can start the new order on a clean chain and crossfade to it,
+     instead of feeding the running delay lines and filters a different signal from one sample to the next.
+     */
+    struct ChainEngine
+    {
+        ChainEngine(VoxProcessorAudioProcessor& proc) : p(proc){}
+        
+        //-120dBFS. Below this a block counts as silence for the idle detection.
+        static constexpr float silenceThreshold = 1.0e-6f;
+        
         DSP_Choice<juce::dsp::Phaser<float>> phaser;
         DSP_Choice<juce::dsp::Chorus<float>> chorus;
-        DSP_Choice<juce::dsp::LadderFilter<float>> overdrive, ladderFilter;
-        DSP_Choice<juce::dsp::IIR::Filter<float>> generalFilter;
-            
-        void prepare(const juce::dsp::ProcessSpec& spec);
-        void updateDSPFromParams();
-        void process(juce::dsp::AudioBlock<float> block, const DSP_Order& dspOrder);
+        DSP_Choice<VoxDSP::Waveshaper> overdrive;
+        DSP_Choice<VoxDSP::LadderFilter> ladderFilter;
+        DSP_Choice<VoxDSP::GeneralFilter> generalFilter;
+        
+        //only the nonlinear stages are oversampled, each one at its own rate
+        VoxDSP::StageOversampling overdriveOversampler, ladderFilterOversampler;
+        
+        DSP_Order order;
+        ProcessingPlan plan;
+        
+        //Only the oversampling filters of the given modes are built.
+        void prepare(const juce::dsp::ProcessSpec& spec, OversamplingMode overdriveMode, OversamplingMode ladderFilterMode);
+        void reset();
+        void compilePlan(juce::uint32 bypassMask);
+        
+        //Message thread. Builds the oversampling filters for new modes, see StageOversampling::prepareMode().
+        //Returns true when something new was built.
+        bool prepareOversampling(OversamplingMode overdriveMode, OversamplingMode ladderFilterMode);
+        
+        //Audio thread. Switches the oversampled stages to the filters prepareOversampling() built. Nothing is allocated.
+        //Returns true when a mode changed.
+        bool switchOversampling();
+        int getLatencyInSamples() const noexcept;
+        
+        //How long the chain keeps ringing after the input stops, from the stages in the plan and their current settings.
+        double getTailLengthSeconds() const noexcept;
+        
+        void updateRampedStages();
+        
+        //inputIsSilent: every sample of the block is below silenceThreshold
+        //feedsAnalyzer: the stage taps are pushed from this chain, only one of them does during a crossfade
+        void process(juce::dsp::AudioBlock<float> block, const ControlFrame* frames, size_t numFrames, bool inputIsSilent, bool feedsAnalyzer);
+        
+        static StageFunction getStageFunction(DSP_Option option);
+        static StageFunction getBypassedStageFunction(DSP_Option option);
+        
+        //The phaser, chorus and overdrive walk through the control frames, the ramped filters take the block in one go.
+        static void processPhaser(ChainEngine& c, juce::dsp::AudioBlock<float> block, const ControlFrame* frames, size_t numFrames);
+        static void processChorus(ChainEngine& c, juce::dsp::AudioBlock<float> block, const ControlFrame* frames, size_t numFrames);
+        static void processOverdrive(ChainEngine& c, juce::dsp::AudioBlock<float> block, const ControlFrame* frames, size_t numFrames);
+        static void processLadderFilter(ChainEngine& c, juce::dsp::AudioBlock<float> block, const ControlFrame* frames, size_t numFrames);
+        static void processGeneralFilter(ChainEngine& c, juce::dsp::AudioBlock<float> block, const ControlFrame* frames, size_t numFrames);
+        
+        //stand ins for bypassed oversampled stages: they only delay the signal by the oversampling latency
+        static void delayOverdrive(ChainEngine& c, juce::dsp::AudioBlock<float> block, const ControlFrame* frames, size_t numFrames);
+        static void delayLadderFilter(ChainEngine& c, juce::dsp::AudioBlock<float> block, const ControlFrame* frames, size_t numFrames);
         
     private:
         
         VoxProcessorAudioProcessor& p;
+        juce::dsp::ProcessSpec hostSpec {};
+        
+        juce::dsp::ProcessSpec getOversampledSpec(const VoxDSP::StageOversampling& oversampler) const noexcept;
+        VoxDSP::StageOversampling* getOversampler(DSP_Option option) noexcept;
+        
+        void updateLadderFilter();
+        void updateGeneralFilter();
         
-        GeneralFilterMode filterMode = GeneralFilterMode::END_OF_LIST;
-        float filterFreq = 0.f, filterQ = 0.f, filterGain= -100.f;
+        /*
+         Idle detection. Once the input and the output of a stage have both stayed below silenceThreshold
+         for longer than the stage can remember (its delay line, its oversampling filters), it goes to sleep:
+         it isn't processed and its parameters aren't updated, the block passes through untouched.
+         The first block that isn't silent wakes it up from a reset, with its parameters snapped to the current
+         values, so there is nothing left in it to click.
+         */
+        struct IdleState
+        {
+            int quietSamples = 0;
+            bool asleep = false;
+        };
+        std::array<IdleState, static_cast<size_t>(DSP_Option::END_OF_LIST)> idleStates;
+        
+        //How long the stage keeps ringing with its current settings, the tail and the idle detection both use it.
+        double getStageDecaySeconds(DSP_Option option) const noexcept;
+        int getStageMemoryInSamples(DSP_Option option) const noexcept;
+        bool isStageRunning(DSP_Option option) const noexcept;
+        void resetStage(DSP_Option option);
     };
     
-    MonoChannelDSP leftChannel{*this};
-    MonoChannelDSP rightChannel{*this};
+    ChainEngine engineA{*this}, engineB{*this};
+    ChainEngine* activeEngine = &engineA;
+    ChainEngine* incomingEngine = nullptr; //only set while a reorder crossfades
+    
+    juce::AudioBuffer<float> crossfadeBuffer;
+    int crossfadeLength = 0, crossfadePosition = 0;
+    
+    void beginReorder(juce::uint32 bypassMask);
+    void crossfadeToIncoming(juce::dsp::AudioBlock<float> block, juce::dsp::AudioBlock<float> incoming);
+    
+    /*
+     Both chains follow the oversampling params. A new mode is built on the message thread by prepareOversampling(),
+     oversamplingIsPrepared hands it to the audio thread, and updateOversampling() switches both chains to it in the same block.
+     The filters belong to the message thread while the flag is off, and to the audio thread while it is on.
+     */
+    bool updateOversampling(); //Returns true when a mode changed.
+    void prepareOversampling();
+    juce::Atomic<bool> oversamplingIsPrepared { false };
+    OversamplingMode getOversamplingMode(const juce::AudioParameterChoice* param) const noexcept
+    {
+        return static_cast<OversamplingMode>(param->getIndex());
+    }
+    
+    static constexpr size_t numAnalysisFeeds = static_cast<size_t>(AnalysisFeed::END_OF_LIST);
+    std::array<juce::Atomic<int>, numAnalysisFeeds> analysisSubscribers;
+    juce::CriticalSection subscriptionLock;
+    bool loudnessWasMeasured = false; //audio thread
+    
+    //the taps of the traces for this block, Off while the spectrum isn't subscribed
+    std::array<AnalysisTap, numAnalyzerTraces> analyzerTaps { AnalysisTap::Off, AnalysisTap::Off };
+    void pushToAnalyzer(AnalysisTap tap, juce::dsp::AudioBlock<const float> block) noexcept;
+    void unsubscribe(AnalysisFeed feed);
+    
+    //the audio thread works out the latency and the tail, the host is told from the message thread
+    juce::Atomic<int> chainLatencySamples { 0 };
+    juce::Atomic<float> tailLengthSeconds { 0.f };
+    float notifiedTailLengthSeconds = 0.f; //message thread
+    void handleAsyncUpdate() override;
+    
+    //Returns true when the tail changed.
+    bool updateTailLength();
     
     template<typename ParamType, typename Params, typename Funcs>
     void initCachedParams(Params paramsArr, Funcs funcsArray)
@@ -220,7 +579,31 @@ private:
     DSP_Choice<juce::dsp::LadderFilter<float>> overdrive, ladderFilter;
 //    DSP_Choice<juce::dsp::IIR::Filter<float>> generalFilter;
 
-    std::vector<juce::SmoothedValue<float>*> getSmoothers();
+    //the parameter behind each smoother in parameterSmoothers, filled in the constructor
+    std::array<juce::AudioParameterFloat*, numSmoothedParams> smoothedParams {};
+   #if VOX_CLAP_DIRECT_EVENTS
+    //Every parameter under the clap_id the wrapper gives it (the hash of the parameter ID), sorted by that id.
+    //Built in the constructor, so handleDirectEvent() only has to search it.
+    struct DirectEventParameter
+    {
+        clap_id id = 0;
+        juce::AudioProcessorParameter* param = nullptr;
+        int smoothedIndex = -1; //into smoothedParams, -1 for the others
+        float lastValue = 0.f;  //normalised, the last one the host sent for the coming block
+        bool hasValue = false;
+    };
+    std::vector<DirectEventParameter> directEventParams;
+    std::vector<DirectEventParameter*> changedDirectEventParams; //reserved for all of them
+    
+    //Sets the parameters the host sent events for to their last value, once each. Start of processBlock().
+    void applyDirectEventValues();
+   #endif
+    
+    //where the smoothers are headed. Taken from the parameters at the start of every block,
+    //except for the ones with events, which change at the event offsets.
+    std::array<float, numSmoothedParams> automationTargets {};
+    VoxDSP::ParameterEventList parameterEvents;
+    static constexpr size_t maxParameterEventsPerBlock = 1024;
     
     enum class SmootherUpdateMode
     {
@@ -229,6 +612,24 @@ private:
     };
     void updateSmoothersFromParams(int numSamplesToSkip, SmootherUpdateMode init);
     
+    StageTicks stageTicks {};
+    
+#if VOX_STAGE_PROFILING
+    struct ScopedStageTimer
+    {
+        ScopedStageTimer(StageTicks& t, ProfiledStage stage) :
+            ticks(t[static_cast<size_t>(stage)]),
+            start(juce::Time::getHighResolutionTicks()) { }
+        ~ScopedStageTimer() { ticks += juce::Time::getHighResolutionTicks() - start; }
+        
+        juce::int64& ticks;
+        juce::int64 start;
+    };
+  #define VOX_PROFILE_STAGE(ticks, stage) const ScopedStageTimer JUCE_JOIN_MACRO(stageTimer_, __LINE__) (ticks, stage)
+#else
+  #define VOX_PROFILE_STAGE(ticks, stage)
+#endif
+    
 #define VERIFY_BYPASS_FUNCTIONALITY false
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (VoxProcessorAudioProcessor)
     